@@ -1,149 +1,416 @@
 #ifndef GPSSIM_HPP
 #define GPSSIM_HPP
 
-#include <math.h>       /* nearbyint */
 #include <vector>
+#include <array>
+#include <type_traits> // conditional
 #include <fstream>
 #include <string>
-#include <algorithm> // for max
-#include "packet.hpp"
+#include <algorithm> // for max min
+#include "packet.hpp" // PacketTable Flow HOLPacket VTime
 #include "priorityQueue.hpp"
+#include "keyedMinHeap.hpp"
+#include "calendarQueue.hpp"
+#include "radixHeap.hpp"
+#include "scanSelector.hpp"
+#include "tournamentTree.hpp"
 
 
-//! maximum number of flows
+//! maximum number of flows of a GPSSim whose flows are fixed at compile time (GPSSim<> has no limit)
 const int MAX_FLOW_NUM = 100;
 //! default number of flows
 const int DEFAULT_FLOW_NUM = 5;
 
+//! priority queue backend of head of line packets, addressed by flow index
+/*! Selected at compile time: define GPS_HOL_CALENDAR_QUEUE for the calendar queue,
+    GPS_HOL_RADIX_HEAP for the radix heap (virtual finish times extracted within a busy
+    period never decrease), GPS_HOL_POINTER_HEAP for the indexed binary heap comparing
+    the HOL entries with HOL_Compare_VFT_G, GPS_HOL_SCAN_SELECTOR for the vectorized linear scan over
+    per-flow finish times (fastest for up to MAX_FLOW_NUM flows; fixed-point finish times
+    are scanned as integers), GPS_HOL_TOURNAMENT_TREE
+    for the tournament tree over flow slots, otherwise the 4-ary heap of cached
+    (finish time, flow index) keys is used. All backends depart packets in the same order.
+*/
+#if defined(GPS_HOL_CALENDAR_QUEUE)
+typedef CalendarQueue<HOLPacket,HOL_Key_VFT,HOL_Compare_VFT_G> HOLQueue;
+#elif defined(GPS_HOL_RADIX_HEAP)
+typedef RadixHeap<HOLPacket,HOL_Key_VFT,HOL_Compare_VFT_G> HOLQueue;
+#elif defined(GPS_HOL_SCAN_SELECTOR)
+typedef ScanSelector<HOLPacket,HOL_Key_VFT> HOLQueue;
+#elif defined(GPS_HOL_TOURNAMENT_TREE)
+typedef TournamentTree<HOLPacket,HOL_Key_VFT> HOLQueue;
+#elif defined(GPS_HOL_POINTER_HEAP)
+typedef IndexedPriorityQueue<HOLPacket,HOL_Compare_VFT_G> HOLQueue;
+#else
+typedef KeyedMinHeap<HOLPacket,HOL_Key_VFT> HOLQueue;
+#endif
+
+//! storage of the flows and of the HOL queue of a GPSSim with N flows fixed at compile time
+/*! Flows live in a std::array and the HOL queue is a tournament tree over N
+    slots with std::array storage, so nothing is allocated for them.
+*/
+template <int N>
+struct GPSStorage{
+	typedef std::array<Flow,N> Flows;
+	typedef TournamentTree<HOLPacket,HOL_Key_VFT,N> Queue;
+};
+//! storage of the flows and of the HOL queue of a GPSSim with the # of flows given at run time
+template <>
+struct GPSStorage<0>{
+	typedef std::vector<Flow> Flows;
+	typedef HOLQueue Queue;
+};
+
+//! weight policy of a GPSSim whose flows may have any weights
+/*! Keeps the total weight of the backlogged flows and the virtual time per
+    nanosecond it gives on the link, which is only recomputed when the total
+    changes, so that no event divides by a weight (fixed-point virtual time
+    divides exactly instead, see VTimeOps).
+*/
+class GeneralWeights{
+	typedef VTimeOps<VTime> Ops;
+	//! link rate
+	Ops::Link mLink;
+	//! total weight of the backlogged flows
+	Ops::Weight mSumWeight;
+	//! virtual time per nanosecond at mSumWeight
+	Ops::Speed mSpeed;
+public:
+	//! constructor with the link rate in bytes per second
+	GeneralWeights(double linkRate = DEFAULT_LINK_RATE)
+	{
+		mLink = Ops::LinkOf(linkRate);
+		Reset();
+	}
+	//! A function to accept the weight of a new flow
+	static void CheckWeight(double)
+	{
+	}
+	//! A function to add a newly backlogged flow
+	void Activate(const Flow *pFlow)
+	{
+		mSumWeight += Ops::WeightOf(pFlow->mWeight);
+		mSpeed = Ops::SpeedOf(mSumWeight,mLink);
+	}
+	//! A function to remove a flow which is no longer backlogged
+	void Deactivate(const Flow *pFlow)
+	{
+		Withdraw(pFlow);
+		Commit();
+	}
+	//! A function to remove a flow which is no longer backlogged, leaving the virtual time rate stale until Commit()
+	void Withdraw(const Flow *pFlow)
+	{
+		mSumWeight -= Ops::WeightOf(pFlow->mWeight);
+	}
+	//! A function to update the virtual time rate after Withdraw()
+	void Commit()
+	{
+		mSpeed = Ops::SpeedOf(mSumWeight,mLink);
+	}
+	//! A function to change the weight of a backlogged flow
+	void Reweight(const Flow *pFlow,double weight)
+	{
+		mSumWeight += Ops::WeightOf(weight) - Ops::WeightOf(pFlow->mWeight);
+		mSpeed = Ops::SpeedOf(mSumWeight,mLink);
+	}
+	//! A function to forget all backlogged flows
+	void Reset()
+	{
+		mSumWeight = 0;
+		mSpeed = Ops::Speed();
+	}
+	//! A function to get the virtual time elapsed in realTime nanoseconds
+	inline VTime VTimeOf(RTime realTime)
+	{
+		return Ops::Elapsed(realTime,mSpeed);
+	}
+	//! A function to get the real time (rounded, in nanoseconds) needed to advance the virtual time by vTime
+	inline RTime RTimeOf(VTime vTime)
+	{
+		return Ops::RealTime(vTime,mSumWeight,mLink);
+	}
+	//! A function to get the virtual time needed to serve length bytes of a flow
+	static inline VTime ServiceVTime(const Flow *pFlow,int length)
+	{
+		return Ops::Service(length,pFlow->mInvWeight);
+	}
+};
+
+//! weight policy of a GPSSim whose flows all have weight DEF_FLOW_WEIGHT
+/*! The total weight is the integer # of backlogged flows, and the virtual service
+    time of a packet is its length.
+*/
+class EqualWeights{
+	typedef VTimeOps<VTime> Ops;
+	//! link rate
+	Ops::Link mLink;
+	//! # of backlogged flows
+	int mActiveNum;
+public:
+	//! constructor with the link rate in bytes per second
+	EqualWeights(double linkRate = DEFAULT_LINK_RATE)
+	{
+		mLink = Ops::LinkOf(linkRate);
+		Reset();
+	}
+	//! A function to accept the weight of a new flow
+	static void CheckWeight(double weight)
+	{
+		if (weight != DEF_FLOW_WEIGHT)
+			throw new std::invalid_argument("Equal-weight GPSSim requires the default flow weight.");
+	}
+	//! A function to add a newly backlogged flow
+	void Activate(const Flow *)
+	{
+		++ mActiveNum;
+	}
+	//! A function to remove a flow which is no longer backlogged
+	void Deactivate(const Flow *)
+	{
+		-- mActiveNum;
+	}
+	//! A function to remove a flow which is no longer backlogged, see Commit()
+	void Withdraw(const Flow *)
+	{
+		-- mActiveNum;
+	}
+	//! A function to update the virtual time rate after Withdraw() (nothing to do)
+	void Commit()
+	{
+	}
+	//! A function to change the weight of a backlogged flow (to the weight it has, see CheckWeight())
+	void Reweight(const Flow *,double)
+	{
+	}
+	//! A function to forget all backlogged flows
+	void Reset()
+	{
+		mActiveNum = 0;
+	}
+	//! A function to get the virtual time elapsed in realTime nanoseconds
+	inline VTime VTimeOf(RTime realTime)
+	{
+		return Ops::ElapsedEqual(realTime,mActiveNum,mLink);
+	}
+	//! A function to get the real time (rounded, in nanoseconds) needed to advance the virtual time by vTime
+	inline RTime RTimeOf(VTime vTime)
+	{
+		return Ops::RealTimeEqual(vTime,mActiveNum,mLink);
+	}
+	//! A function to get the virtual time needed to serve length bytes of a flow
+	static inline VTime ServiceVTime(const Flow *,int length)
+	{
+		return Ops::OfBytes(length);
+	}
+};
 
 //! class GPS simulator
+/*!
+	N = 0 (GPSSim<>) takes the # of flows at run time. N > 0 fixes it at compile
+	time: flows and HOL queue are kept in std::array storage (see GPSStorage),
+	flow lookup is bounded by the constant N, and constructing the simulator
+	allocates no memory for them.
+	WeightPolicy (GeneralWeights or EqualWeights) does the virtual time arithmetic.
+	Real times are 64-bit nanoseconds (RTime) on a link of linkRate bytes per
+	second, DEFAULT_LINK_RATE (one byte per nanosecond) unless specified.
+	Packets are rows of a PacketTable given to the constructor, referred to by
+	PacketIndex; the simulator writes their finish and departure times.
+	Flows are indexed by the flow indices of the PacketTable. GPSSim<> creates
+	a flow, at the default weight, on first sight of its index, so its flow
+	array grows with the # of flows however sparse their ids are.
+*/
+template <int N = 0,class WeightPolicy = GeneralWeights>
 class GPSSim{
+	static_assert(N >= 0 && N <= MAX_FLOW_NUM,"GPSSim flow number must be in [0,MAX_FLOW_NUM].");
 	//! virtual time of last event
-	double mThenVTime;
+	VTime mThenVTime;
 	//! real time of last event
-	long int mThenRTime;
-	//! current total weight
-	double mSumWeight;
+	RTime mThenRTime;
+	//! total weight of the backlogged flows
+	WeightPolicy mWeights;
 	//! is the system idle currently
 	bool mIdling;
-	//! priority queue of head of line packets
-	PriorityQueue<Packet *,PKT_Compare_VFT_G> *mpPQ_HOL;
+	//! # of busy periods ended so far, see Flow::Renew()
+	uint64_t mEpoch;
+	//! packets simulated
+	PacketTable *mpPackets;
+	//! priority queue of head of line packets, addressed by flow index
+	typename GPSStorage<N>::Queue mPQ_HOL;
 	//! the packet served currently
-	Packet *mpCurPacket;
+	HOLPacket mCurPacket;
 	//! real time for next wakeup
-	long int mNextWakeupRTime;
-	//! flows
-	std::vector<Flow*> mpFlows;
+	RTime mNextWakeupRTime;
+	//! flows, indexed by flow index in the packet table
+	typename GPSStorage<N>::Flows mFlows;
 	//! number of flows
 	int mFlowNum;
+	//! A function to get the number of flows, a compile-time constant if N > 0
+	inline int FlowNum()
+	{
+		return (N > 0) ? N : mFlowNum;
+	}
+	//! A function to check the number of flows given to a constructor
+	static int CheckFlowNum(int flowNum)
+	{
+		if (flowNum < 0 || (N > 0 && flowNum != N))
+			throw new std::invalid_argument("GPSSim flow number does not match its capacity.");
+		return flowNum;
+	}
+	//! A function to create growable flow storage
+	static void InitFlows(std::vector<Flow>& flows,int flowNum)
+	{
+		flows.resize(flowNum);
+	}
+	//! A function to initialize fixed flow storage
+	static void InitFlows(std::array<Flow,N>&,int)
+	{
+	}
+	//! A function to create flows at the default weight, up to flowNum, in growable flow storage
+	static bool GrowFlows(std::vector<Flow>& flows,int flowNum)
+	{
+		flows.resize(flowNum);
+		return true;
+	}
+	//! A function to refuse to create flows in fixed flow storage
+	static bool GrowFlows(std::array<Flow,N>&,int)
+	{
+		return false;
+	}
+	//! A function to make sure that the flow of index flowIndex exists, return false if it cannot
+	inline bool BindFlow(int flowIndex)
+	{
+		if (flowIndex < FlowNum())
+			return flowIndex >= 0;
+		if (!GrowFlows(mFlows,flowIndex + 1))
+			return false;
+		mFlowNum = flowIndex + 1;
+		return true;
+	}
+	//! A function to get the HOL queue entry of packet i of the flow of index flowIndex
+	inline HOLPacket HOLEntry(PacketIndex i,int flowIndex)
+	{
+		HOLPacket entry = {mpPackets->mGPS_VFTime[i],i,flowIndex};
+		return entry;
+	}
 public:
 	//! constructor
-	GPSSim(int flowNum = DEFAULT_FLOW_NUM){
-		mThenVTime = 0.0;
+	GPSSim(PacketTable *pPackets,int flowNum = (N > 0) ? N : DEFAULT_FLOW_NUM,double linkRate = DEFAULT_LINK_RATE)
+		: mWeights(linkRate),mPQ_HOL(CheckFlowNum(flowNum))
+	{
+		mThenVTime = 0;
 		mThenRTime = 0;
-		mSumWeight = 0.0;
 		mIdling = true;
-		mpPQ_HOL = new PriorityQueue<Packet *,PKT_Compare_VFT_G>();
-		mpCurPacket = NULL;
+		mEpoch = 0;
+		mpPackets = pPackets;
+		mCurPacket = HOLPacket();
 		mNextWakeupRTime = 0;
 		mFlowNum = flowNum;
-		for (int i = 0;i < flowNum;++ i)
-			mpFlows.push_back(new Flow());
+		InitFlows(mFlows,flowNum);
 	}
-	//! constructor
-	GPSSim(std::vector<double> flowWeights)
+	//! constructor, flowWeights[i] being the weight of the flow of index i
+	GPSSim(PacketTable *pPackets,std::vector<double> flowWeights,double linkRate = DEFAULT_LINK_RATE)
+		: mWeights(linkRate),mPQ_HOL(CheckFlowNum(flowWeights.size()))
 	{
-		mThenVTime = 0.0;
+		mThenVTime = 0;
 		mThenRTime = 0;
-		mSumWeight = 0.0;
 		mIdling = true;
-		mpPQ_HOL = new PriorityQueue<Packet *,PKT_Compare_VFT_G>();
-		mpCurPacket = NULL;
-		mNextWakeupRTime = 0;
+		mEpoch = 0;
+		mpPackets = pPackets;
 		mFlowNum = flowWeights.size();
-
+		mCurPacket = HOLPacket();
+		mNextWakeupRTime = 0;
+		InitFlows(mFlows,mFlowNum);
 		for (int i = 0;i < mFlowNum;++ i)
-			mpFlows.push_back(new Flow(flowWeights[i]));		
+		{
+			WeightPolicy::CheckWeight(flowWeights[i]);
+			mFlows[i] = Flow(flowWeights[i]);
+		}
 	}
 
-	void HandleNewPacketArrival(Packet *pPKT);
-	void WakeupProcessing(long nowRTime);
-	void ResetTimer(long nowRTime,double nowVTime,double newWakeupVTime);
-	long GetNextWakeupRTime();
-	bool BindPacket2Flow(Packet *pPKT);
+	//! flows hold the packets in flight, so the simulator is not copyable
+	GPSSim(const GPSSim&) = delete;
+	GPSSim& operator=(const GPSSim&) = delete;
+
+	void HandleNewPacketArrival(PacketIndex i);
+	int64_t HandleNewPacketArrivals(PacketIndex begin,PacketIndex end);
+	int WakeupProcessing(RTime nowRTime);
+	int64_t AdvanceTo(RTime realTime);
+	int64_t Drain();
+	void ResetTimer(RTime nowRTime,VTime nowVTime,VTime newWakeupVTime);
+	RTime GetNextWakeupRTime();
+	bool IsIdle();
+	int FlowIndexOf(PacketIndex i);
 	void CleanUpAfterBusyPeriod();
-	
+	void TearDownFlow(FlowId flowId,RTime nowRTime);
+	void SetFlowWeight(FlowId flowId,double weight,RTime nowRTime);
+private:
+	void AppendBurst(Flow *pFlow,PacketIndex begin,PacketIndex end);
+	VTime AdvanceVTime(RTime nowRTime);
+	void RescheduleAfterHOLChange(RTime nowRTime,VTime nowVTime);
 };
-//! function bind the packet to the corresponding flow
-bool GPSSim::BindPacket2Flow(Packet *pPKT)
+//! function to get the index of the flow of packet i
+template <int N,class WeightPolicy>
+inline int GPSSim<N,WeightPolicy>::FlowIndexOf(PacketIndex i)
 {
-	int flowId = pPKT->mFlowId - 1;
-	if (flowId >= 0 && flowId < mFlowNum)
-	{
-		pPKT->SetFlow(mpFlows[flowId]);
-		return true;
-	}
-	return false;
+	int flowIndex = mpPackets->mFlowIndex[i];
+	if (!BindFlow(flowIndex))
+		throw new std::runtime_error("Cannot bind the packet to a unknown flow.");
+	return flowIndex;
 }
 //! function to handle the newly arrived packet
-void GPSSim::HandleNewPacketArrival(Packet *pPKT)
+template <int N,class WeightPolicy>
+void GPSSim<N,WeightPolicy>::HandleNewPacketArrival(PacketIndex i)
 {
 	//! current virtual time 
-	double nowVTime;
+	VTime nowVTime;
 	//! current real time
-	long int nowRTime;
+	RTime nowRTime;
 	//! flow pointer
 	Flow *pFlow;
-	//! packet pointer points to the packet which is enjoying the service
-	Packet *pCurPacket;
     //! get current real time
-	nowRTime = pPKT->mArrivalTime;
+	nowRTime = mpPackets->mArrivalTime[i];
 
 	//! check whether is system is idle or not
 	if (mIdling)
 	{
-		nowVTime = 0.0;
+		nowVTime = 0;
 		mIdling = false;
 	}
 	else
 	{
 		//! calculate current virtual time
-		nowVTime = mThenVTime + (nowRTime - mThenRTime) / mSumWeight;
+		nowVTime = mThenVTime + mWeights.VTimeOf(nowRTime - mThenRTime);
 	}
 
-	//! bind the arrival packet to flow
-	if (!BindPacket2Flow(pPKT))
-		throw new std::runtime_error("Cannot bind the packet to a unknown flow.");
-
 	//! get the flow to which the newly arrived packet belongs
-	pFlow = pPKT->mpFlow;
+	int flowIndex = FlowIndexOf(i);
+	pFlow = &mFlows[flowIndex];
+	//! forget its state from an earlier busy period
+	pFlow->Renew(mEpoch);
 	//! get the flow's backlog status
 	bool b = pFlow->IsBackloggedUnderGPS();
 
 	if (!b)
 	{
 		//! newly active flow
-		mSumWeight += pFlow->mWeight;
+		mWeights.Activate(pFlow);
 	}
 
 	//! calculate the GPS virtual finish time for the newly arrived packet
-	pPKT->mGPS_VFTime = std::max(nowVTime,pFlow->GetLastPacketVFTime()) + pPKT->mLength / pFlow->mWeight;
+	mpPackets->mGPS_VFTime[i] = std::max(nowVTime,pFlow->GetLastPacketVFTime()) + WeightPolicy::ServiceVTime(pFlow,mpPackets->mLength[i]);
+	CheckFinishTime(mpPackets->mGPS_VFTime[i]);
 	//! append the packet into the corresponding flow
-	pFlow->AppendPacket(pPKT);
+	pFlow->AppendPacket(i,*mpPackets);
 
 	if (!b)
 	{
 		//! put the newly arrived packet into the priority queue of the head of line packet
-		mpPQ_HOL->Enqueue(pPKT);
+		mPQ_HOL.Enqueue(flowIndex,HOLEntry(i,flowIndex));
 		//! get the packet with minimum GPS finish time
-		pCurPacket = mpPQ_HOL->PeekMin();
-		//! check whether it is the same as the current packet
-		if (pCurPacket != mpCurPacket)
-		{
-			mpCurPacket = pCurPacket;
-		}
+		mCurPacket = mPQ_HOL.PeekMin();
 		//! reset the wakeup time
-		ResetTimer(nowRTime,nowVTime,mpCurPacket->mGPS_VFTime);
+		ResetTimer(nowRTime,nowVTime,mCurPacket.mGPS_VFTime);
 	}
 	//! update the virtual time of last event
 	mThenVTime = nowVTime;
@@ -151,58 +418,248 @@ void GPSSim::HandleNewPacketArrival(Packet *pPKT)
 	mThenRTime = nowRTime;
 
 }
-//! wakeup process
-void GPSSim::WakeupProcessing(long nowRTime)
+//! function to handle the newly arrived packets [begin,end), sorted by arrival time, return the # of departures
+/*!
+	Departures due before each packet are processed first, as AdvanceTo() does.
+	The packets of a flow which follow one of its packets and arrive before the
+	next departure form a burst: the flow stays backlogged, so neither the HOL
+	queue nor the timer changes, and their finish times are the prefix sums of
+	their service times from the flow's last finish time (see AppendBurst()).
+	The results are those of HandleNewPacketArrival() packet by packet.
+*/
+template <int N,class WeightPolicy>
+int64_t GPSSim<N,WeightPolicy>::HandleNewPacketArrivals(PacketIndex begin,PacketIndex end)
 {
-	double nowVTime;
-	Flow *pFlow;
-	Packet *pPKT;
-	nowVTime = mpCurPacket->mGPS_VFTime;
-	mpPQ_HOL->PopMin();
-	pFlow = mpCurPacket->mpFlow;
-	pFlow->PopHOL();
+	const PacketColumn<int32_t>& flowIndices = mpPackets->mFlowIndex;
+	const PacketColumn<RTime>& arrivalTimes = mpPackets->mArrivalTime;
+	int64_t departures = 0;
+	PacketIndex i = begin;
+	while (i < end)
+	{
+		departures += AdvanceTo(arrivalTimes[i]);
+		HandleNewPacketArrival(i);
+		PacketIndex j = i + 1;
+		while (j < end && flowIndices[j] == flowIndices[i] && arrivalTimes[j] < mNextWakeupRTime)
+			++ j;
+		AppendBurst(&mFlows[flowIndices[i]],i + 1,j);
+		i = j;
+	}
+	return departures;
+}
 
-	if (pFlow->IsBackloggedUnderGPS())
+//! function to append the burst of packets [begin,end) arriving to the backlogged flow pFlow before the next departure
+/*!
+	The last finish time of a backlogged flow is not below its HOL packet's,
+	hence not below the virtual time until the next departure, so each finish
+	time is the previous one plus the packet's service time: the service times
+	are written to the finish time column and summed up there in place.
+	They are checked in order, so the first one out of range is reported
+	even if later sums wrapped around.
+	Virtual time is still advanced at every new arrival time, so that later
+	events see the same virtual times.
+*/
+template <int N,class WeightPolicy>
+void GPSSim<N,WeightPolicy>::AppendBurst(Flow *pFlow,PacketIndex begin,PacketIndex end)
+{
+	if (begin >= end) return;
+	VTime *finishTimes = &mpPackets->mGPS_VFTime[begin];
+	const uint16_t *lengths = &mpPackets->mLength[begin];
+	int n = end - begin;
+	for (int k = 0;k < n;++ k)
+		finishTimes[k] = WeightPolicy::ServiceVTime(pFlow,lengths[k]);
+	VTimeOps<VTime>::PrefixSum(pFlow->GetLastPacketVFTime(),finishTimes,n);
+	for (PacketIndex i = begin;i < end;++ i)
 	{
-		pPKT = pFlow->PeekHOL();
-		mpPQ_HOL->Enqueue(pPKT);
+		CheckFinishTime(mpPackets->mGPS_VFTime[i]);
+		pFlow->AppendPacket(i,*mpPackets);
+		RTime arrivalTime = mpPackets->mArrivalTime[i];
+		if (arrivalTime != mThenRTime)
+		{
+			mThenVTime = mThenVTime + mWeights.VTimeOf(arrivalTime - mThenRTime);
+			mThenRTime = arrivalTime;
+		}
 	}
-	else
+}
+
+//! wakeup process, return the # of departures
+/*!
+	Every HOL packet finishing at the virtual time of the packet in service
+	departs in this one step, in the order of the HOL queue: the timer would
+	otherwise fire again after zero real time for each of them. Their flows'
+	weights are withdrawn in the same order and the virtual time rate is
+	updated once, and each successor takes over its flow's entry in place.
+*/
+template <int N,class WeightPolicy>
+int GPSSim<N,WeightPolicy>::WakeupProcessing(RTime nowRTime)
+{
+	VTime nowVTime;
+	Flow *pFlow;
+	HOLPacket hol;
+	int departures = 0;
+	nowVTime = mCurPacket.mGPS_VFTime;
+	do
 	{
-		mSumWeight -= pFlow->mWeight;
+		hol = mPQ_HOL.PeekMin();
+		mpPackets->mGPS_DepartureTime[hol.mPacket] = nowRTime;
+		pFlow = &mFlows[hol.mFlowIndex];
+		pFlow->PopHOL();
+		++ departures;
+
+		if (pFlow->IsBackloggedUnderGPS())
+		{
+			//! the flow's next packet takes over its entry: a single sift
+			mPQ_HOL.ReplaceMin(HOLEntry(pFlow->PeekHOL(*mpPackets),hol.mFlowIndex));
+		}
+		else
+		{
+			mPQ_HOL.PopMin();
+			mWeights.Withdraw(pFlow);
+		}
+	} while (!mPQ_HOL.Empty() && mPQ_HOL.PeekMin().mGPS_VFTime == nowVTime);
+	mWeights.Commit();
+	//! the departure is an event: later virtual times are measured from it, at the new total weight
+	mThenVTime = nowVTime;
+	mThenRTime = nowRTime;
+	RescheduleAfterHOLChange(nowRTime,nowVTime);
+	return departures;
+}
+
+//! function to process every departure due at or before realTime, return the # of departures
+template <int N,class WeightPolicy>
+int64_t GPSSim<N,WeightPolicy>::AdvanceTo(RTime realTime)
+{
+	int64_t n = 0;
+	while (!mIdling && mNextWakeupRTime <= realTime)
+	{
+		n += WakeupProcessing(mNextWakeupRTime);
 	}
-	mpCurPacket = mpPQ_HOL->PeekMin();
-	if (mpCurPacket == NULL)
+	return n;
+}
+
+//! function to process every remaining departure until the system is idle, return the # of departures
+template <int N,class WeightPolicy>
+int64_t GPSSim<N,WeightPolicy>::Drain()
+{
+	int64_t n = 0;
+	while (!mIdling)
+		n += WakeupProcessing(mNextWakeupRTime);
+	return n;
+}
+
+//! function to advance the virtual time to real time nowRTime (no departure may be pending before nowRTime)
+template <int N,class WeightPolicy>
+VTime GPSSim<N,WeightPolicy>::AdvanceVTime(RTime nowRTime)
+{
+	VTime nowVTime = mIdling ? 0 : mThenVTime + mWeights.VTimeOf(nowRTime - mThenRTime);
+	mThenVTime = nowVTime;
+	mThenRTime = nowRTime;
+	return nowVTime;
+}
+
+//! function to pick the packet in service and reset the timer after the HOL queue changed
+template <int N,class WeightPolicy>
+void GPSSim<N,WeightPolicy>::RescheduleAfterHOLChange(RTime nowRTime,VTime nowVTime)
+{
+	if (mPQ_HOL.Empty())
 	{
 		CleanUpAfterBusyPeriod();
 	}
 	else
 	{
-		ResetTimer(nowRTime,nowVTime,mpCurPacket->mGPS_VFTime);
+		mCurPacket = mPQ_HOL.PeekMin();
+		ResetTimer(nowRTime,nowVTime,mCurPacket.mGPS_VFTime);
+	}
+}
+
+//! function to tear down a flow at real time nowRTime, dropping its backlog
+/*! Departures due up to nowRTime are processed first; nowRTime must not
+    precede the last event.
+*/
+template <int N,class WeightPolicy>
+void GPSSim<N,WeightPolicy>::TearDownFlow(FlowId flowId,RTime nowRTime)
+{
+	int flowIndex = mpPackets->FindFlow(flowId);
+	if (!BindFlow(flowIndex))
+		throw new std::runtime_error("Cannot tear down an unknown flow.");
+	if (nowRTime < mThenRTime)
+		throw new std::invalid_argument("Cannot tear down a flow before the last event.");
+	AdvanceTo(nowRTime);
+	Flow *pFlow = &mFlows[flowIndex];
+	if (!pFlow->IsBackloggedUnderGPS())
+	{
+		pFlow->Clear();
+		return;
 	}
+	VTime nowVTime = AdvanceVTime(nowRTime);
+	mPQ_HOL.Erase(flowIndex);
+	mWeights.Deactivate(pFlow);
+	pFlow->Clear();
+	RescheduleAfterHOLChange(nowRTime,nowVTime);
+}
+
+//! function to change the weight of a flow at real time nowRTime
+/*! Departures due up to nowRTime are processed first; nowRTime must not
+    precede the last event.
+*/
+template <int N,class WeightPolicy>
+void GPSSim<N,WeightPolicy>::SetFlowWeight(FlowId flowId,double weight,RTime nowRTime)
+{
+	int flowIndex = mpPackets->FindFlow(flowId);
+	if (!BindFlow(flowIndex))
+		throw new std::runtime_error("Cannot change the weight of an unknown flow.");
+	WeightPolicy::CheckWeight(weight);
+	if (nowRTime < mThenRTime)
+		throw new std::invalid_argument("Cannot change the weight of a flow before the last event.");
+	AdvanceTo(nowRTime);
+	Flow *pFlow = &mFlows[flowIndex];
+	if (!pFlow->IsBackloggedUnderGPS())
+	{
+		pFlow->SetWeight(weight,0,*mpPackets);
+		return;
+	}
+	VTime nowVTime = AdvanceVTime(nowRTime);
+	mWeights.Reweight(pFlow,weight);
+	pFlow->SetWeight(weight,nowVTime,*mpPackets);
+	//! the HOL packet's finish time changed
+	mPQ_HOL.Replace(flowIndex,HOLEntry(pFlow->PeekHOL(*mpPackets),flowIndex));
+	RescheduleAfterHOLChange(nowRTime,nowVTime);
 }
 
 //! function to reset timer
-void GPSSim::ResetTimer(long int nowRTime,double nowVTime,double newWakeupVTime)
+template <int N,class WeightPolicy>
+void GPSSim<N,WeightPolicy>::ResetTimer(RTime nowRTime,VTime nowVTime,VTime newWakeupVTime)
 {
-	int newInterval;
-	newInterval = (int) nearbyint((newWakeupVTime - nowVTime) * mSumWeight);
+	RTime newInterval;
+	newInterval = mWeights.RTimeOf(newWakeupVTime - nowVTime);
 	mNextWakeupRTime = nowRTime + newInterval;
 }
 
 //! function to get next wakeup time
-long GPSSim::GetNextWakeupRTime()
+template <int N,class WeightPolicy>
+RTime GPSSim<N,WeightPolicy>::GetNextWakeupRTime()
 {
 	return mNextWakeupRTime;
 }
 
+//! function to check whether no packet is backlogged (the state is then as good as new)
+template <int N,class WeightPolicy>
+bool GPSSim<N,WeightPolicy>::IsIdle()
+{
+	return mIdling;
+}
+
 //! function to cleanup
-void GPSSim::CleanUpAfterBusyPeriod()
+template <int N,class WeightPolicy>
+void GPSSim<N,WeightPolicy>::CleanUpAfterBusyPeriod()
 {
 	mThenVTime = 0;
 	mNextWakeupRTime = 0;
 	mIdling = true;
-	mSumWeight = 0.0;
+	//! flows are reset lazily, when first touched in the next busy period
+	++ mEpoch;
+	mWeights.Reset();
+	//! virtual time restarts from 0 (the queue is empty, so this is cheap)
+	mPQ_HOL.Clear();
 }
 
 
@@ -0,0 +1,53 @@
+/*
+	Benchmark: HOL priority queue backend of GPSSim on a recorded trace
+	
+	The backend is selected at compile time, so build this file once per
+	backend and run the binaries on the same trace:
+	    g++ -O2 -DNDEBUG benchHOLQueue.cpp -o benchHeap
+	    g++ -O2 -DNDEBUG -DGPS_HOL_POINTER_HEAP benchHOLQueue.cpp -o benchPointerHeap
+	    g++ -O2 -DNDEBUG -DGPS_HOL_CALENDAR_QUEUE benchHOLQueue.cpp -o benchCalendar
+	    g++ -O2 -DNDEBUG -DGPS_HOL_RADIX_HEAP benchHOLQueue.cpp -o benchRadix
+	    g++ -O2 -DNDEBUG -mavx2 -DGPS_HOL_SCAN_SELECTOR benchHOLQueue.cpp -o benchScan
+	    g++ -O2 -DNDEBUG -DGPS_HOL_TOURNAMENT_TREE benchHOLQueue.cpp -o benchTournament
+	    ./benchHeap packets.dat && ./benchPointerHeap packets.dat && ./benchCalendar packets.dat && ./benchRadix packets.dat && ./benchScan packets.dat && ./benchTournament packets.dat
+*/
+#include <iostream>
+#include <chrono>
+#include "packetScheduler.hpp"
+
+#if defined(GPS_HOL_CALENDAR_QUEUE)
+const char *HOL_BACKEND = "calendar queue";
+#elif defined(GPS_HOL_RADIX_HEAP)
+const char *HOL_BACKEND = "radix heap";
+#elif defined(GPS_HOL_SCAN_SELECTOR)
+const char *HOL_BACKEND = "vectorized linear scan";
+#elif defined(GPS_HOL_TOURNAMENT_TREE)
+const char *HOL_BACKEND = "tournament tree over flow slots";
+#elif defined(GPS_HOL_POINTER_HEAP)
+const char *HOL_BACKEND = "binary heap of packet pointers";
+#else
+const char *HOL_BACKEND = "4-ary heap of cached keys";
+#endif
+
+int main(int argc,char **argv)
+{
+	if (argc < 2)
+	{
+		std::cout << "usage: " << argv[0] << " <trace file> [repetitions]" << std::endl;
+		return 1;
+	}
+	int repetitions = (argc > 2) ? atoi(argv[2]) : 5;
+
+	double best = 0;
+	for (int r = 0;r < repetitions;++ r)
+	{
+		PacketScheduler ps(argv[1]);
+		auto start = std::chrono::steady_clock::now();
+		ps.simulate();
+		auto stop = std::chrono::steady_clock::now();
+		double ms = std::chrono::duration<double,std::milli>(stop - start).count();
+		if (r == 0 || ms < best) best = ms;
+	}
+	std::cout << HOL_BACKEND << ": best of " << repetitions << " runs " << best << " ms" << std::endl;
+	return 0;
+}
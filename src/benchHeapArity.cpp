@@ -0,0 +1,70 @@
+/*
+	Benchmark: fanout of the HOL priority queue used by GPSSim
+	
+	Every flow is backlogged and owns one HOL packet in the queue. Each
+	departure pops the packet with the minimum virtual finish time and
+	enqueues the next packet of the same flow (finish time advanced by
+	length / weight), which is the steady state of GPSSim::WakeupProcessing.
+*/
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include "priorityQueue.hpp"
+#include "packet.hpp"
+
+const int PACKET_SIZES[] = {40,100,576,1500};
+
+template <int Arity>
+double BenchHOLQueue(int flowNum,long departures)
+{
+	std::mt19937 gen(flowNum);
+	std::uniform_int_distribution<int> pickSize(0,3);
+	std::uniform_int_distribution<int> pickWeight(1,4);
+
+	std::vector<double> weights(flowNum);
+	// one Packet object per flow, allocated individually as the trace parser does
+	std::vector<Packet *> hol(flowNum);
+	PriorityQueue<Packet *,PKT_Compare_VFT_G,Arity> pq;
+	for (int i = 0;i < flowNum;++ i)
+	{
+		weights[i] = pickWeight(gen);
+		hol[i] = new Packet(i + 1,0,PACKET_SIZES[pickSize(gen)],0);
+		hol[i]->mGPS_VFTime = hol[i]->mLength / weights[i];
+		pq.Enqueue(hol[i]);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (long n = 0;n < departures;++ n)
+	{
+		Packet *p = pq.PeekMin();
+		pq.PopMin();
+		int f = p->mFlowId - 1;
+		p->mLength = PACKET_SIZES[n & 3];
+		p->mGPS_VFTime += p->mLength / weights[f];
+		pq.Enqueue(p);
+	}
+	auto stop = std::chrono::steady_clock::now();
+
+	for (auto p: hol)
+		delete p;
+	return std::chrono::duration<double,std::nano>(stop - start).count() / departures;
+}
+
+int main()
+{
+	const int flowNums[] = {100,10000,1000000};
+	const long departures = 2000000;
+
+	std::cout << "ns per departure (PopMin + Enqueue), " << departures << " departures\n";
+	std::cout << "flows\tarity 2\tarity 4\tarity 8\n";
+	for (int f: flowNums)
+	{
+		std::cout << f
+		          << "\t" << BenchHOLQueue<2>(f,departures)
+		          << "\t" << BenchHOLQueue<4>(f,departures)
+		          << "\t" << BenchHOLQueue<8>(f,departures)
+		          << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,55 @@
+/*
+	Benchmark: busy-period-parallel simulation of a recorded trace
+
+	Simulates the trace sequentially and on 1, 2, 4, ... threads up to the
+	# of cores, and checks that every parallel run gives the same virtual
+	finish times as the sequential one. Speedup grows with the # of busy
+	periods, i.e., on lightly loaded traces:
+	    g++ -O2 -DNDEBUG -pthread benchParallel.cpp -o benchParallel
+	    ./benchParallel packets.dat
+*/
+#include <iostream>
+#include <chrono>
+#include "packetScheduler.hpp"
+
+//! A function to get the best time (ms) of repetitions simulations of a trace on threadNum threads (sequential if 0)
+double BenchSimulate(const char *input,int threadNum,int repetitions,std::vector<VTime>& finishTimes)
+{
+	double best = 0;
+	for (int r = 0;r < repetitions;++ r)
+	{
+		PacketScheduler ps(input);
+		auto start = std::chrono::steady_clock::now();
+		if (threadNum == 0)
+			ps.simulate();
+		else
+			ps.simulateParallel(threadNum);
+		auto stop = std::chrono::steady_clock::now();
+		double ms = std::chrono::duration<double,std::milli>(stop - start).count();
+		if (r == 0 || ms < best) best = ms;
+		if (r == 0) finishTimes = ps.GetFinishTimes();
+	}
+	return best;
+}
+
+int main(int argc,char **argv)
+{
+	if (argc < 2)
+	{
+		std::cout << "usage: " << argv[0] << " <trace file> [repetitions]" << std::endl;
+		return 1;
+	}
+	int repetitions = (argc > 2) ? atoi(argv[2]) : 5;
+	int coreNum = std::max(1u,std::thread::hardware_concurrency());
+
+	std::vector<VTime> sequential,parallel;
+	double base = BenchSimulate(argv[1],0,repetitions,sequential);
+	std::cout << "sequential: " << base << " ms" << std::endl;
+	for (int threadNum = 1;threadNum <= coreNum;threadNum *= 2)
+	{
+		double ms = BenchSimulate(argv[1],threadNum,repetitions,parallel);
+		std::cout << threadNum << " threads: " << ms << " ms, speedup " << base / ms
+		          << (parallel == sequential ? "" : " (results differ!)") << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,114 @@
+/*
+	Benchmark: tournament tree vs. MinHeap as HOL selector of GPSSim under overload
+	
+	Most flows are backlogged. Each departure takes the packet with the
+	minimum virtual finish time; with probability BACKLOGGED_PERCENT the same
+	flow stays backlogged and its next packet replaces it (finish time advanced
+	by length / weight), otherwise the flow goes idle and a random idle flow
+	becomes backlogged, which keeps the backlogged fraction constant.
+*/
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include "priorityQueue.hpp"
+#include "tournamentTree.hpp"
+#include "packet.hpp"
+
+const int PACKET_SIZES[] = {40,100,576,1500};
+//! percentage of backlogged flows (and of departures after which the flow stays backlogged)
+const int BACKLOGGED_PERCENT = 90;
+
+//! selector of the MinHeap run
+struct HeapSelector {
+	PriorityQueue<Packet *,PKT_Compare_VFT_G> mPQ;
+	explicit HeapSelector(int flowNum): mPQ(flowNum) {}
+	void Enqueue(int,Packet *p) { mPQ.Enqueue(p); }
+	Packet *PeekMin() { return mPQ.PeekMin(); }
+	void PopMin() { mPQ.PopMin(); }
+	void ReplaceMin(Packet *p) { mPQ.PopMin(); mPQ.Enqueue(p); }
+};
+
+//! selector of the tournament tree run
+struct TreeSelector {
+	TournamentTree<Packet *,PKT_Key_VFT> mTree;
+	explicit TreeSelector(int flowNum): mTree(flowNum) {}
+	void Enqueue(int flowIndex,Packet *p) { mTree.Enqueue(flowIndex,p); }
+	Packet *PeekMin() { return mTree.PeekMin(); }
+	void PopMin() { mTree.PopMin(); }
+	void ReplaceMin(Packet *p) { mTree.ReplaceMin(p); }
+};
+
+template <class Selector>
+double BenchSelector(int flowNum,long departures)
+{
+	std::mt19937 gen(flowNum);
+	std::uniform_int_distribution<int> pickSize(0,3);
+	std::uniform_int_distribution<int> pickWeight(1,4);
+	std::uniform_int_distribution<int> pickPercent(0,99);
+
+	std::vector<double> weights(flowNum);
+	// one Packet object per flow, allocated individually as the trace parser does
+	std::vector<Packet *> hol(flowNum);
+	std::vector<int> idle;
+	Selector sel(flowNum);
+	for (int i = 0;i < flowNum;++ i)
+	{
+		weights[i] = pickWeight(gen);
+		hol[i] = new Packet(i + 1,0,PACKET_SIZES[pickSize(gen)],0);
+		hol[i]->mGPS_VFTime = hol[i]->mLength / weights[i];
+		if (pickPercent(gen) < BACKLOGGED_PERCENT)
+			sel.Enqueue(i,hol[i]);
+		else
+			idle.push_back(i);
+	}
+	// decisions are drawn up front, so both selectors replay the same sequence
+	std::vector<char> stays(departures);
+	std::vector<int> wakes(departures);
+	for (long n = 0;n < departures;++ n)
+	{
+		stays[n] = pickPercent(gen) < BACKLOGGED_PERCENT;
+		wakes[n] = idle.empty() ? 0 : gen() % idle.size();
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (long n = 0;n < departures;++ n)
+	{
+		Packet *p = sel.PeekMin();
+		int f = p->mFlowId - 1;
+		p->mLength = PACKET_SIZES[n & 3];
+		p->mGPS_VFTime += p->mLength / weights[f];
+		if (stays[n] || idle.empty())
+		{
+			sel.ReplaceMin(p);
+			continue;
+		}
+		sel.PopMin();
+		int w = idle[wakes[n]];
+		idle[wakes[n]] = f;
+		hol[w]->mGPS_VFTime = p->mGPS_VFTime;
+		sel.Enqueue(w,hol[w]);
+	}
+	auto stop = std::chrono::steady_clock::now();
+
+	for (auto p: hol)
+		delete p;
+	return std::chrono::duration<double,std::nano>(stop - start).count() / departures;
+}
+
+int main()
+{
+	const int flowNums[] = {100,10000,1000000};
+	const long departures = 2000000;
+
+	std::cout << "ns per departure, " << BACKLOGGED_PERCENT << "% of the flows backlogged, " << departures << " departures\n";
+	std::cout << "flows\tMinHeap\ttournament tree\n";
+	for (int f: flowNums)
+	{
+		std::cout << f
+		          << "\t" << BenchSelector<HeapSelector>(f,departures)
+		          << "\t" << BenchSelector<TreeSelector>(f,departures)
+		          << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,287 @@
+/*
+	C++ Implementation for Calendar Queue
+	version 1.0.0
+
+*/
+
+#ifndef CALENDAR_QUEUE_HPP
+#define CALENDAR_QUEUE_HPP
+
+#include <iostream>
+#include <vector>
+#include <functional> // greater
+#include <algorithm> // nth_element sort
+#include <math.h> // floor
+#include <stdexcept> // underflow out_of_range
+
+//! minimum # of buckets of a calendar queue
+const int CQ_MIN_BUCKET_NUM = 16;
+//! # of smallest keys sampled to estimate the bucket width on resize
+const int CQ_WIDTH_SAMPLE_NUM = 25;
+
+//! The calendar queue class
+/*!
+	Priority queue with O(1) amortized enqueue/dequeue for (mostly) monotone keys
+	(R. Brown, "Calendar Queues", CACM 1988). Elements are hashed by their
+	numeric key (given by KeyOf) into "days" of width mWidth, and bucket
+	b holds all days d with d mod mBucketNum = b, sorted by the total order
+	given by Compare. The number of buckets follows the number of elements and
+	the width is re-estimated from the smallest keys on every resize.
+	Compare must be consistent with KeyOf (a smaller key is never greater) and
+	should be a total order, so that the departure order is identical to the
+	one of MinHeap with the same Compare, ties included.
+	Elements are addressed by integer handles like IndexedMinHeap, so this
+	class is a drop-in replacement of IndexedPriorityQueue.
+*/
+template <class TYPE,class KeyOf,class Compare=std::greater<TYPE> >
+class CalendarQueue{
+	//! bucket entry: element, its cached key and day, and its handle
+	struct Entry{
+		TYPE mValue;
+		double mKey;
+		long long mDay;
+		int mHandle;
+	};
+	//! buckets, each sorted in decreasing order (minimum at the back)
+	std::vector<std::vector<Entry> > mBuckets;
+	//! bucket of each handle, -1 if the handle has no element
+	std::vector<int> mBucketOf;
+	//! # of buckets (a power of 2)
+	int mBucketNum;
+	//! width of a day
+	double mWidth;
+	//! no element has a day smaller than mCurDay
+	long long mCurDay;
+	//! bucket holding the minimum element, -1 if unknown
+	int mMinBucket;
+	//! # of elements
+	int mSize;
+	//! key function
+	KeyOf mKeyOf;
+	//! comparison function
+	Compare mGreater;
+	//! A function to compare two entries, true if e1 comes after e2
+	inline bool Greater(const Entry& e1,const Entry& e2)
+	{
+		if (e1.mKey != e2.mKey) return e1.mKey > e2.mKey;
+		return mGreater(e1.mValue,e2.mValue);
+	}
+	//! A function to get the day of a key
+	inline long long DayOf(double key)
+	{
+		return (long long) floor(key / mWidth);
+	}
+	//! A function to put an entry into its bucket
+	void Place(const Entry& e)
+	{
+		int b = (int) (e.mDay & (mBucketNum - 1));
+		std::vector<Entry>& bucket = mBuckets[b];
+		size_t i = bucket.size();
+		bucket.push_back(e);
+		while (i > 0 && Greater(e,bucket[i - 1]))
+		{
+			bucket[i] = bucket[i - 1];
+			-- i;
+		}
+		bucket[i] = e;
+		mBucketOf[e.mHandle] = b;
+		if (e.mDay < mCurDay) mCurDay = e.mDay;
+		if (mMinBucket >= 0 && Greater(mBuckets[mMinBucket].back(),e)) mMinBucket = b;
+	}
+	//! A function to locate the bucket holding the minimum element
+	int LocateMin()
+	{
+		if (mMinBucket >= 0) return mMinBucket;
+		//! scan one year, starting at the current day
+		long long day = mCurDay;
+		for (int n = 0;n < mBucketNum;++ n,++ day)
+		{
+			int b = (int) (day & (mBucketNum - 1));
+			if (!mBuckets[b].empty() && mBuckets[b].back().mDay <= day)
+			{
+				mCurDay = day;
+				mMinBucket = b;
+				return b;
+			}
+		}
+		//! nothing within a year: direct search over all buckets
+		int minBucket = -1;
+		for (int b = 0;b < mBucketNum;++ b)
+			if (!mBuckets[b].empty() && (minBucket < 0 || Greater(mBuckets[minBucket].back(),mBuckets[b].back())))
+				minBucket = b;
+		mCurDay = mBuckets[minBucket].back().mDay;
+		mMinBucket = minBucket;
+		return minBucket;
+	}
+	//! A function to remove the entry of a handle, and return it
+	Entry Remove(int handle)
+	{
+		if (!Contains(handle))
+			throw new std::out_of_range("CalendarQueue has no element with this handle.");
+		int b = mBucketOf[handle];
+		std::vector<Entry>& bucket = mBuckets[b];
+		size_t i = 0;
+		while (bucket[i].mHandle != handle) ++ i;
+		Entry e = bucket[i];
+		//! the minimum is only lost when the back of its bucket goes
+		if (b == mMinBucket && i + 1 == bucket.size()) mMinBucket = -1;
+		bucket.erase(bucket.begin() + i);
+		mBucketOf[handle] = -1;
+		-- mSize;
+		return e;
+	}
+	//! A function to insert an entry, resizing the calendar if needed
+	void Add(Entry e)
+	{
+		if (e.mHandle < 0)
+			throw new std::out_of_range("CalendarQueue handle must be non-negative.");
+		if (e.mHandle >= (int) mBucketOf.size()) mBucketOf.resize(e.mHandle + 1,-1);
+		if (mBucketOf[e.mHandle] >= 0)
+			throw new std::runtime_error("CalendarQueue handle already owns an element.");
+		if (mSize + 1 > 2 * mBucketNum) Resize(2 * mBucketNum);
+		e.mDay = DayOf(e.mKey);
+		if (mSize == 0) mCurDay = e.mDay;
+		Place(e);
+		++ mSize;
+	}
+	//! A function to change the # of buckets and re-estimate the width of a day
+	void Resize(int bucketNum)
+	{
+		std::vector<Entry> entries;
+		entries.reserve(mSize);
+		for (auto& bucket: mBuckets)
+			entries.insert(entries.end(),bucket.begin(),bucket.end());
+
+		//! average separation of the smallest keys, 3 times of which is Brown's width
+		int n = std::min((int) entries.size(),CQ_WIDTH_SAMPLE_NUM);
+		if (n >= 2)
+		{
+			auto byKey = [](const Entry& e1,const Entry& e2) { return e1.mKey < e2.mKey; };
+			std::nth_element(entries.begin(),entries.begin() + (n - 1),entries.end(),byKey);
+			std::sort(entries.begin(),entries.begin() + n,byKey);
+			double span = entries[n - 1].mKey - entries[0].mKey;
+			if (span > 0) mWidth = 3.0 * span / (n - 1);
+		}
+
+		mBucketNum = bucketNum;
+		mBuckets.assign(mBucketNum,std::vector<Entry>());
+		mMinBucket = -1;
+		mCurDay = entries.empty() ? 0 : DayOf(entries[0].mKey);
+		for (auto& e: entries)
+		{
+			e.mDay = DayOf(e.mKey);
+			Place(e);
+		}
+	}
+public:
+	//! A constructor with the expected number of handles and the initial width of a day specified
+	explicit CalendarQueue(int handleNum = 0,double width = 1.0,KeyOf uKeyOf = KeyOf(),Compare uGreater = Compare())// constructor
+	{
+		if (width <= 0)
+			throw new std::invalid_argument("CalendarQueue width must be positive.");
+		mBucketNum = CQ_MIN_BUCKET_NUM;
+		mBuckets.assign(mBucketNum,std::vector<Entry>());
+		mBucketOf.assign(handleNum,-1);
+		mWidth = width;
+		mCurDay = 0;
+		mMinBucket = -1;
+		mSize = 0;
+		mKeyOf = uKeyOf;
+		mGreater = uGreater;
+	}
+	//! A function to check whether a handle currently owns an element
+	bool Contains(int handle)
+	{
+		return handle >= 0 && handle < (int) mBucketOf.size() && mBucketOf[handle] >= 0;
+	}
+	//! A function to insert an element under a handle which currently owns no element
+	void Enqueue(int handle,TYPE x)
+	{
+		Add(Entry{x,(double) mKeyOf(x),0,handle});
+	}
+	//! A function to replace the element of a handle by x
+	void Replace(int handle,TYPE x)
+	{
+		Remove(handle);
+		Add(Entry{x,(double) mKeyOf(x),0,handle});
+	}
+	//! A function to restore the order after the key of a handle's element changed in place
+	void Update(int handle)
+	{
+		Entry e = Remove(handle);
+		e.mKey = mKeyOf(e.mValue);
+		Add(e);
+	}
+	//! A function to remove the element of a handle
+	void Erase(int handle)
+	{
+		Remove(handle);
+		if (mBucketNum > CQ_MIN_BUCKET_NUM && mSize < mBucketNum / 2) Resize(mBucketNum / 2);
+	}
+	//! A function to answer the query of the minimum element
+	TYPE PeekMin()
+	{
+		if (Empty())
+			throw new std::underflow_error("CalendarQueue underflow.");
+		return mBuckets[LocateMin()].back().mValue;
+	}
+	//! A function to get the handle of the minimum element
+	int MinHandle()
+	{
+		if (Empty())
+			throw new std::underflow_error("CalendarQueue underflow.");
+		return mBuckets[LocateMin()].back().mHandle;
+	}
+	//! A function to remove the minimum element
+	void PopMin()
+	{
+		Erase(MinHandle());
+	}
+	//! A function to replace the minimum element by x (owned by the same handle)
+	void ReplaceMin(TYPE x)
+	{
+		int handle = MinHandle();
+		Remove(handle);
+		Add(Entry{x,(double) mKeyOf(x),0,handle});
+	}
+	//! A function to remove all elements, O(1) when the queue is already empty
+	void Clear()
+	{
+		if (mSize > 0)
+			for (auto& bucket: mBuckets)
+			{
+				for (auto& e: bucket)
+					mBucketOf[e.mHandle] = -1;
+				bucket.clear();
+			}
+		mSize = 0;
+		mMinBucket = -1;
+	}
+	//! A function to track whether the queue is empty
+	bool Empty()
+	{
+		return (mSize == 0);
+	}
+	//! A function to get the current size of the queue
+	int Size()
+	{
+		return mSize;
+	}
+	//! A function to get the current width of a day
+	double Width()
+	{
+		return mWidth;
+	}
+	//! A function to print out the elements (with their handles), bucket by bucket
+	void Print()
+	{
+		for (int b = 0;b < mBucketNum;++ b)
+			for (auto it = mBuckets[b].rbegin();it != mBuckets[b].rend();++ it)
+				std::cout << it->mHandle << ":" << it->mValue << " ";
+		std::cout << std::endl;
+	}
+};
+
+
+
+#endif
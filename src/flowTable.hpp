@@ -0,0 +1,163 @@
+/*
+	C++ Implementation for Flow Id Hash Table
+	version 1.0.0
+
+*/
+
+#ifndef FLOW_TABLE_HPP
+#define FLOW_TABLE_HPP
+
+#include <iostream>
+#include <vector>
+#include <stddef.h> // size_t
+#include <stdint.h> // uint64_t int32_t
+#include <stdexcept> // out_of_range length_error
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//! id of a flow, as carried by its packets (e.g., a hash of their 5-tuple)
+typedef uint64_t FlowId;
+
+//! # of slots compared at once by a probe of the flow table
+const int FLOW_TABLE_GROUP = 4;
+//! initial # of slot groups of a flow table (a power of two)
+const size_t FLOW_TABLE_MIN_GROUPS = 4;
+
+//! The flow table class
+/*!
+	Maps arbitrary 64-bit flow ids to dense flow indices 0,1,2,... given in
+	order of first sight, so that flow state can be kept in a contiguous
+	array growing with the # of flows rather than with the largest id.
+	Open addressing: the slots are split in groups of FLOW_TABLE_GROUP, and an
+	id is searched from the group its hash picks on, group after group, until
+	a group holds it or has an empty slot. A probe compares the id with the
+	whole group at once (one AVX2 compare, two SSE2 compares, or scalar code,
+	picked at compile time). Ids are never removed; the table doubles when
+	half full. The id of each flow index is kept in a contiguous array.
+*/
+class FlowTable{
+	//! ids of the slots (0 for empty slots)
+	std::vector<FlowId> mKeys;
+	//! flow indices of the slots (-1 for empty slots)
+	std::vector<int32_t> mIndices;
+	//! id of each flow index
+	std::vector<FlowId> mIds;
+	//! # of bits of the group number
+	int mGroupBits;
+	//! A function to get the group an id is first searched in
+	inline size_t HomeGroup(FlowId id) const
+	{
+		//! Fibonacci hashing: the high bits of the product depend on all bits of the id
+		return (size_t) ((id * 0x9E3779B97F4A7C15ULL) >> (64 - mGroupBits));
+	}
+	//! A function to get the slot holding id, or else the first empty slot where it would be put
+	size_t Probe(FlowId id) const
+	{
+		size_t mask = ((size_t) 1 << mGroupBits) - 1;
+		for (size_t g = HomeGroup(id);;g = (g + 1) & mask)
+		{
+			const FlowId *keys = &mKeys[g * FLOW_TABLE_GROUP];
+			const int32_t *indices = &mIndices[g * FLOW_TABLE_GROUP];
+			//! empty slots have an index of -1, i.e., their sign bit set
+#if defined(__AVX2__)
+			__m256i k = _mm256_set1_epi64x((long long) id);
+			int match = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *) keys),k)));
+			int empty = _mm_movemask_ps(_mm_castsi128_ps(_mm_loadu_si128((const __m128i *) indices)));
+#elif defined(__SSE2__)
+			__m128i k = _mm_set1_epi64x((long long) id);
+			//! 64-bit lanes are equal if both of their 32-bit halves are
+			__m128i lo = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) keys),k);
+			__m128i hi = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (keys + 2)),k);
+			lo = _mm_and_si128(lo,_mm_shuffle_epi32(lo,0xB1));
+			hi = _mm_and_si128(hi,_mm_shuffle_epi32(hi,0xB1));
+			int match = _mm_movemask_pd(_mm_castsi128_pd(lo)) | (_mm_movemask_pd(_mm_castsi128_pd(hi)) << 2);
+			int empty = _mm_movemask_ps(_mm_castsi128_ps(_mm_loadu_si128((const __m128i *) indices)));
+#else
+			int match = 0,empty = 0;
+			for (int j = 0;j < FLOW_TABLE_GROUP;++ j)
+			{
+				match |= (keys[j] == id) << j;
+				empty |= (indices[j] < 0) << j;
+			}
+#endif
+			match &= ~empty;
+			if (match) return g * FLOW_TABLE_GROUP + __builtin_ctz(match);
+			if (empty) return g * FLOW_TABLE_GROUP + __builtin_ctz(empty);
+		}
+	}
+	//! A function to resize the table to groupNum groups (a power of two), reinserting the ids
+	void Rehash(size_t groupNum)
+	{
+		mKeys.assign(groupNum * FLOW_TABLE_GROUP,0);
+		mIndices.assign(groupNum * FLOW_TABLE_GROUP,-1);
+		mGroupBits = __builtin_ctzll(groupNum);
+		for (size_t i = 0;i < mIds.size();++ i)
+		{
+			size_t slot = Probe(mIds[i]);
+			mKeys[slot] = mIds[i];
+			mIndices[slot] = (int32_t) i;
+		}
+	}
+public:
+	//! A constructor
+	FlowTable()
+	{
+		Rehash(FLOW_TABLE_MIN_GROUPS);
+	}
+	//! A function to get the index of flow id, -1 if it was never seen
+	inline int Find(FlowId id) const
+	{
+		return mIndices[Probe(id)];
+	}
+	//! A function to get the index of flow id, giving it the next index if it was never seen
+	inline int IndexOf(FlowId id)
+	{
+		size_t slot = Probe(id);
+		if (mIndices[slot] >= 0)
+			return mIndices[slot];
+		if (mIds.size() >= (size_t) INT32_MAX)
+			throw new std::length_error("FlowTable is full.");
+		int index = (int) mIds.size();
+		mIds.push_back(id);
+		if (2 * mIds.size() > mIndices.size())
+			Rehash(2 * mIndices.size() / FLOW_TABLE_GROUP);
+		else
+		{
+			mKeys[slot] = id;
+			mIndices[slot] = index;
+		}
+		return index;
+	}
+	//! A function to get the id of flow index
+	inline FlowId IdOf(int index) const
+	{
+		if (index < 0 || index >= Size())
+			throw new std::out_of_range("FlowTable has no flow with this index.");
+		return mIds[index];
+	}
+	//! A function to get the # of flows
+	inline int Size() const
+	{
+		return (int) mIds.size();
+	}
+	//! A function to forget all flows
+	void Clear()
+	{
+		mIds.clear();
+		Rehash(FLOW_TABLE_MIN_GROUPS);
+	}
+	//! A function to print the flows by index
+	void Print()
+	{
+		for (int i = 0;i < Size();++ i)
+			std::cout << i << ":" << mIds[i] << " ";
+		std::cout << std::endl;
+	}
+};
+
+
+
+#endif
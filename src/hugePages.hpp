@@ -0,0 +1,117 @@
+/*
+	C++ Implementation for Huge Page Allocator
+	version 1.0.0
+
+*/
+
+#ifndef HUGE_PAGES_HPP
+#define HUGE_PAGES_HPP
+
+#include <new> // operator new, bad_alloc
+#include <type_traits> // true_type
+#include <stddef.h> // size_t
+#if defined(__linux__)
+#include <sys/mman.h> // mmap munmap madvise
+#endif
+
+//! size of a huge page in bytes: 2 MiB on x86-64
+const size_t HUGE_PAGE_BYTES = 2 << 20;
+
+//! The huge page allocator class
+/*!
+	A standard allocator for containers of hundreds of millions of elements,
+	such as the columns of a PacketTable. With hugePages, blocks of at least
+	HUGE_PAGE_BYTES are mapped on Linux from huge pages (MAP_HUGETLB) if the
+	system reserves any, else as transparent huge pages (MADV_HUGEPAGE), which
+	cuts TLB misses when scanning them. Smaller blocks, and every block
+	without hugePages or off Linux, come from operator new.
+	Allocators compare equal when they agree on hugePages, and propagate with
+	their container on copy, move and swap.
+*/
+template <class T>
+class HugePageAllocator{
+	//! map large blocks from huge pages
+	bool mHugePages;
+	//! A function to check whether a block of bytes is mapped
+	bool Mapped(size_t bytes) const
+	{
+#if defined(__linux__)
+		return mHugePages && bytes >= HUGE_PAGE_BYTES;
+#else
+		return false;
+#endif
+	}
+	//! A function to get the # of bytes mapped for a block of bytes: whole huge pages
+	static size_t MappedBytes(size_t bytes)
+	{
+		return (bytes + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+	}
+	template <class U> friend class HugePageAllocator;
+public:
+	typedef T value_type;
+	typedef std::true_type propagate_on_container_copy_assignment;
+	typedef std::true_type propagate_on_container_move_assignment;
+	typedef std::true_type propagate_on_container_swap;
+	//! A constructor, mapping large blocks from huge pages if hugePages
+	HugePageAllocator(bool hugePages = false)
+	{
+		mHugePages = hugePages;
+	}
+	//! A constructor from the allocator of another type
+	template <class U>
+	HugePageAllocator(const HugePageAllocator<U>& other)
+	{
+		mHugePages = other.mHugePages;
+	}
+	//! A function to allocate room for n objects
+	T* allocate(size_t n)
+	{
+		size_t bytes = n * sizeof(T);
+#if defined(__linux__)
+		if (Mapped(bytes))
+		{
+			void *p = mmap(NULL,MappedBytes(bytes),PROT_READ | PROT_WRITE,MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,-1,0);
+			if (p == MAP_FAILED)
+			{
+				p = mmap(NULL,MappedBytes(bytes),PROT_READ | PROT_WRITE,MAP_PRIVATE | MAP_ANONYMOUS,-1,0);
+				if (p == MAP_FAILED)
+					throw std::bad_alloc();
+				madvise(p,MappedBytes(bytes),MADV_HUGEPAGE);
+			}
+			return (T *) p;
+		}
+#endif
+		return (T *) ::operator new(bytes);
+	}
+	//! A function to release the room for n objects at p
+	void deallocate(T *p,size_t n)
+	{
+#if defined(__linux__)
+		if (Mapped(n * sizeof(T)))
+		{
+			munmap(p,MappedBytes(n * sizeof(T)));
+			return;
+		}
+#endif
+		::operator delete(p);
+	}
+	//! A function to check whether large blocks are mapped from huge pages
+	bool HugePages() const
+	{
+		return mHugePages;
+	}
+	template <class U>
+	bool operator==(const HugePageAllocator<U>& other) const
+	{
+		return mHugePages == other.mHugePages;
+	}
+	template <class U>
+	bool operator!=(const HugePageAllocator<U>& other) const
+	{
+		return mHugePages != other.mHugePages;
+	}
+};
+
+
+
+#endif
@@ -0,0 +1,284 @@
+/*
+	C++ Implementation for Indexed (addressable) Min Heap
+	version 1.0.0
+
+*/
+
+#ifndef INDEXED_MIN_HEAP_HPP
+#define INDEXED_MIN_HEAP_HPP
+
+#include <iostream>
+#include <vector>
+#include <functional> // greater
+#include <algorithm> // min
+#include <stdexcept> // underflow out_of_range
+#include <iterator> // distance
+
+//! The indexed minHeap class
+/*!
+ 	Generic min d-ary heap whose elements are addressed by stable integer handles
+	(e.g., flow indices). Every handle owns at most one element at a time, and the
+	position of each handle in the heap is tracked, so the element of any handle
+	can be replaced, re-keyed or erased in O(log n).
+	Elements are stored inline together with their handle, so comparisons only
+	touch the contiguous heap array.
+*/
+template <class TYPE,class Compare=std::greater<TYPE>,int Arity = 2>
+class IndexedMinHeap{
+	static_assert(Arity >= 2,"IndexedMinHeap fanout must be at least 2.");
+	//! heap node: element and its handle
+	struct Node{
+		TYPE mValue;
+		int mHandle;
+	};
+	//! heap nodes, stored from index 1 (index 0 is unused)
+	std::vector<Node> mNodes;
+	//! position of each handle in mNodes, 0 if the handle has no element
+	std::vector<int> mPos;
+	//! # of elements
+	int mSize;
+	//! comparison function
+	Compare mGreater;
+	//! A function to get the index of the parent of node i (i > 1)
+	static inline int Parent(int i)
+	{
+		return (i - 2) / Arity + 1;
+	}
+	//! A function to get the index of the first child of node i
+	static inline int FirstChild(int i)
+	{
+		return Arity * (i - 1) + 2;
+	}
+	//! A function to get the # of levels of a heap with n elements
+	static int Depth(int n)
+	{
+		int depth = 0;
+		for (long long levelEnd = 1,levelSize = 1;n > 0;levelSize *= Arity,levelEnd += levelSize)
+		{
+			++ depth;
+			if (n <= levelEnd) break;
+		}
+		return depth;
+	}
+	//! A function to put node x at position i and record its position
+	inline void Place(int i,const Node& x)
+	{
+		mNodes[i] = x;
+		mPos[x.mHandle] = i;
+	}
+	//! A function to move the node at position i up until its parent is not greater
+	void Swim(int i)
+	{
+		Node x = mNodes[i];
+		int parent;
+		while (i > 1)
+		{
+			parent = Parent(i);
+			if (!mGreater(mNodes[parent].mValue,x.mValue)) break;
+			Place(i,mNodes[parent]);
+			i = parent;
+		}
+		Place(i,x);
+	}
+	//! A function to move the node at position i down until none of its children is smaller
+	void Sink(int i)
+	{
+		Node x = mNodes[i];
+		int first,last,j;
+		while ((first = FirstChild(i)) <= mSize)
+		{
+			last = std::min(first + Arity - 1,mSize);
+			j = first;
+			for (int c = first + 1;c <= last;++ c)
+				if (mGreater(mNodes[j].mValue,mNodes[c].mValue)) j = c;
+			if (!mGreater(x.mValue,mNodes[j].mValue)) break;
+			Place(i,mNodes[j]);
+			i = j;
+		}
+		Place(i,x);
+	}
+	//! A function to restore the heap property around position i after its key changed either way
+	void Fix(int i)
+	{
+		if (i > 1 && mGreater(mNodes[Parent(i)].mValue,mNodes[i].mValue))
+			Swim(i);
+		else
+			Sink(i);
+	}
+	//! A function to get the position of a handle, throws if the handle has no element
+	int PositionOf(int handle)
+	{
+		if (!Contains(handle))
+			throw new std::out_of_range("IndexedMinHeap has no element with this handle.");
+		return mPos[handle];
+	}
+public:
+	//! A constructor with the expected number of handles specified
+	explicit IndexedMinHeap(int handleNum = 0,Compare uGreater = Compare())// constructor
+	{
+		mNodes.resize(handleNum + 1);
+		mPos.assign(handleNum,0);
+		mSize = 0;
+		mGreater = uGreater;
+	}
+	//! A function to check whether a handle currently owns an element
+	bool Contains(int handle)
+	{
+		return handle >= 0 && handle < (int) mPos.size() && mPos[handle] != 0;
+	}
+	//! A function to get the element of a handle
+	TYPE Get(int handle)
+	{
+		return mNodes[PositionOf(handle)].mValue;
+	}
+	//! A function to insert an element under a handle which currently owns no element
+	void Insert(int handle,TYPE x)
+	{
+		if (handle < 0)
+			throw new std::out_of_range("IndexedMinHeap handle must be non-negative.");
+		if (handle >= (int) mPos.size()) mPos.resize(handle + 1,0);
+		if (mPos[handle] != 0)
+			throw new std::runtime_error("IndexedMinHeap handle already owns an element.");
+		++ mSize;
+		if (mSize >= (int) mNodes.size()) mNodes.resize(2 * mNodes.size());
+		mNodes[mSize] = Node{x,handle};
+		Swim(mSize);
+	}
+	//! A function to insert the (handle, element) pairs of a range [first,last) of forward iterators at once
+	/*! Like MinHeap::InsertRange(), a large batch is repaired Floyd-style by sinking
+	    every ancestor of the new nodes once, bottom-up.
+	*/
+	template <class ForwardIt>
+	void InsertRange(ForwardIt first,ForwardIt last)
+	{
+		int k = std::distance(first,last);
+		if (mSize + k >= (int) mNodes.size()) mNodes.resize(std::max(mSize + k + 1,2 * (int) mNodes.size()));
+		int firstNew = mSize + 1;
+		for (;first != last;++ first)
+		{
+			int handle = first->first;
+			if (handle < 0)
+				throw new std::out_of_range("IndexedMinHeap handle must be non-negative.");
+			if (handle >= (int) mPos.size()) mPos.resize(handle + 1,0);
+			if (mPos[handle] != 0)
+				throw new std::runtime_error("IndexedMinHeap handle already owns an element.");
+			++ mSize;
+			Place(mSize,Node{first->second,handle});
+		}
+		if (k <= 0) return;
+		if (k <= Depth(mSize))
+		{
+			for (int i = firstNew;i <= mSize;++ i)
+				Swim(i);
+			return;
+		}
+		if (mSize < 2) return;
+		int lo = Parent(std::max(firstNew,2));
+		int hi = Parent(mSize);
+		while (true)
+		{
+			for (int i = hi;i >= lo;-- i)
+				Sink(i);
+			if (lo == 1) break;
+			lo = Parent(lo);
+			hi = Parent(hi);
+		}
+	}
+	//! A function to replace the element of a handle by x, with a single sift
+	void Replace(int handle,TYPE x)
+	{
+		int i = PositionOf(handle);
+		mNodes[i].mValue = x;
+		Fix(i);
+	}
+	//! A function to restore the order after the key of a handle's element changed in place
+	void Update(int handle)
+	{
+		Fix(PositionOf(handle));
+	}
+	//! A function to remove the element of a handle
+	void Erase(int handle)
+	{
+		int i = PositionOf(handle);
+		mPos[handle] = 0;
+		if (i != mSize)
+		{
+			Place(i,mNodes[mSize]);
+			-- mSize;
+			Fix(i);
+		}
+		else
+		{
+			-- mSize;
+		}
+	}
+	//! A function to answer the query of the minimum element in the heap
+	TYPE Min()
+	{
+		if (Empty())
+			throw new std::underflow_error("IndexedMinHeap underflow.");
+		return mNodes[1].mValue;
+	}
+	//! A function to get the handle of the minimum element in the heap
+	int MinHandle()
+	{
+		if (Empty())
+			throw new std::underflow_error("IndexedMinHeap underflow.");
+		return mNodes[1].mHandle;
+	}
+	//! A function to answer the query of the minimum element in the heap and then remove it
+	TYPE ExtractMin()
+	{
+		TYPE minElem = Min();
+		Erase(mNodes[1].mHandle);
+		return minElem;
+	}
+	//! A function to replace the minimum element by x (owned by the same handle), with a single sift
+	void ReplaceMin(TYPE x)
+	{
+		if (Empty())
+			throw new std::underflow_error("IndexedMinHeap underflow.");
+		mNodes[1].mValue = x;
+		Sink(1);
+	}
+	//! A function to remove all elements
+	void Clear()
+	{
+		for (int i = 1;i <= mSize;++ i)
+			mPos[mNodes[i].mHandle] = 0;
+		mSize = 0;
+	}
+	//! A function to track whether the heap is empty
+	bool Empty()
+	{
+		return (mSize == 0);
+	}
+	//! A function to get the current size of the heap
+	int Size()
+	{
+		return mSize;
+	}
+	//! A function to check whether the array satisfies the minHeap property and the positions are consistent
+	bool IsMinHeap()
+	{
+		for (int i = 1;i <= mSize;++ i)
+		{
+			if (mPos[mNodes[i].mHandle] != i) return false;
+			if (i > 1 && mGreater(mNodes[Parent(i)].mValue,mNodes[i].mValue)) return false;
+		}
+		return true;
+	}
+	//! A function to print out the elements (with their handles) in the heap
+	void Print()
+	{
+		for (int i = 1;i <= mSize;++ i)
+		{
+			std::cout << mNodes[i].mHandle << ":" << mNodes[i].mValue << " ";
+		}
+		std::cout << std::endl;
+	}
+};
+
+
+
+#endif
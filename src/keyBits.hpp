@@ -0,0 +1,39 @@
+/*
+	Order-preserving integer images of numeric keys
+	version 1.0.0
+
+*/
+
+#ifndef KEY_BITS_HPP
+#define KEY_BITS_HPP
+
+#include <string.h> // memcpy
+#include <stdint.h> // uint64_t
+#include <stdexcept> // out_of_range
+
+//! A function to map a non-negative double to an unsigned integer of the same order
+/*! The IEEE-754 bit pattern of non-negative doubles is monotone when read as an unsigned integer.
+*/
+inline uint64_t KeyBits(double key)
+{
+	if (!(key >= 0))
+		throw new std::out_of_range("Integer keys require non-negative values.");
+	uint64_t bits;
+	memcpy(&bits,&key,sizeof(bits));
+	return bits;
+}
+//! A function to map a non-negative integer to an unsigned integer of the same order
+inline uint64_t KeyBits(long long key)
+{
+	if (key < 0)
+		throw new std::out_of_range("Integer keys require non-negative values.");
+	return (uint64_t) key;
+}
+//! A function to map an unsigned integer key to itself
+inline uint64_t KeyBits(unsigned long long key)
+{
+	return (uint64_t) key;
+}
+
+
+#endif
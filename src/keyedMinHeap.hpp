@@ -0,0 +1,244 @@
+/*
+	C++ Implementation for Keyed Indexed Min Heap
+	version 1.0.0
+
+*/
+
+#ifndef KEYED_MIN_HEAP_HPP
+#define KEYED_MIN_HEAP_HPP
+
+#include <iostream>
+#include <vector>
+#include <algorithm> // min
+#include <stdint.h> // uint64_t
+#include <stdexcept> // underflow out_of_range
+#include "keyBits.hpp"
+#include "minHeap.hpp" // HeapStorage
+
+//! The keyed indexed minHeap class
+/*!
+	Indexed d-ary min heap (see IndexedMinHeap) which caches the key of every
+	element in the heap array. A node is the 128-bit integer
+	(KeyBits(key) << 32) | handle, so sifting compares nodes with a single
+	branch-free integer comparison and never dereferences the elements;
+	ties on the key are broken by the smaller handle. The elements themselves
+	are kept in a side array indexed by handle and only read by PeekMin().
+	Nodes are 16 bytes, so with Arity = 4 the children of a node share one
+	cache line.
+	KeyOf must return non-negative doubles or integers, see KeyBits().
+*/
+template <class TYPE,class KeyOf,int Arity = 4>
+class KeyedMinHeap{
+	static_assert(Arity >= 2,"KeyedMinHeap fanout must be at least 2.");
+	//! heap node: (KeyBits(key) << 32) | handle, i.e., key bits in bits 32 to 95, handle in the low 32 bits
+	typedef unsigned __int128 Node;
+	//! heap nodes, stored from index 1
+	HeapStorage<Node> mNodes;
+	//! position of each handle in mNodes, 0 if the handle has no element
+	std::vector<int> mPos;
+	//! element of each handle
+	std::vector<TYPE> mValues;
+	//! # of elements
+	int mSize;
+	//! key function
+	KeyOf mKeyOf;
+	//! A function to get the index of the parent of node i (i > 1)
+	static inline int Parent(int i)
+	{
+		return (i - 2) / Arity + 1;
+	}
+	//! A function to get the index of the first child of node i
+	static inline int FirstChild(int i)
+	{
+		return Arity * (i - 1) + 2;
+	}
+	//! A function to get the handle of a node
+	static inline int HandleOf(Node x)
+	{
+		return (int) (uint32_t) x;
+	}
+	//! A function to build the node of a handle owning element x
+	inline Node MakeNode(int handle,const TYPE& x)
+	{
+		return ((Node) KeyBits(mKeyOf(x)) << 32) | (uint32_t) handle;
+	}
+	//! A function to put node x at position i and record its position
+	inline void Place(int i,Node x)
+	{
+		mNodes[i] = x;
+		mPos[HandleOf(x)] = i;
+	}
+	//! A function to move the node at position i up until its parent is not greater
+	void Swim(int i)
+	{
+		Node x = mNodes[i];
+		int parent;
+		while (i > 1)
+		{
+			parent = Parent(i);
+			if (mNodes[parent] <= x) break;
+			Place(i,mNodes[parent]);
+			i = parent;
+		}
+		Place(i,x);
+	}
+	//! A function to move the node at position i down until none of its children is smaller
+	void Sink(int i)
+	{
+		Node x = mNodes[i];
+		int first,last,j;
+		while ((first = FirstChild(i)) <= mSize)
+		{
+			last = std::min(first + Arity - 1,mSize);
+			j = first;
+			for (int c = first + 1;c <= last;++ c)
+				j = (mNodes[c] < mNodes[j]) ? c : j;
+			if (x <= mNodes[j]) break;
+			Place(i,mNodes[j]);
+			i = j;
+		}
+		Place(i,x);
+	}
+	//! A function to restore the heap property around position i after its key changed either way
+	void Fix(int i)
+	{
+		if (i > 1 && mNodes[i] < mNodes[Parent(i)])
+			Swim(i);
+		else
+			Sink(i);
+	}
+	//! A function to get the position of a handle, throws if the handle has no element
+	int PositionOf(int handle)
+	{
+		if (!Contains(handle))
+			throw new std::out_of_range("KeyedMinHeap has no element with this handle.");
+		return mPos[handle];
+	}
+public:
+	//! A constructor with the expected number of handles specified
+	explicit KeyedMinHeap(int handleNum = 0,KeyOf uKeyOf = KeyOf())// constructor
+		: mNodes(handleNum + 1)
+	{
+		mPos.assign(handleNum,0);
+		mValues.resize(handleNum);
+		mSize = 0;
+		mKeyOf = uKeyOf;
+	}
+	//! A function to check whether a handle currently owns an element
+	bool Contains(int handle)
+	{
+		return handle >= 0 && handle < (int) mPos.size() && mPos[handle] != 0;
+	}
+	//! A function to insert an element under a handle which currently owns no element
+	void Enqueue(int handle,TYPE x)
+	{
+		if (handle < 0)
+			throw new std::out_of_range("KeyedMinHeap handle must be non-negative.");
+		if (handle >= (int) mPos.size())
+		{
+			mPos.resize(handle + 1,0);
+			mValues.resize(handle + 1);
+		}
+		if (mPos[handle] != 0)
+			throw new std::runtime_error("KeyedMinHeap handle already owns an element.");
+		++ mSize;
+		if (mSize >= mNodes.Capacity()) mNodes.Reallocate(2 * mNodes.Capacity(),mSize - 1);
+		mValues[handle] = x;
+		Place(mSize,MakeNode(handle,x));
+		Swim(mSize);
+	}
+	//! A function to replace the element of a handle by x, with a single sift
+	void Replace(int handle,TYPE x)
+	{
+		int i = PositionOf(handle);
+		mValues[handle] = x;
+		mNodes[i] = MakeNode(handle,x);
+		Fix(i);
+	}
+	//! A function to restore the order after the key of a handle's element changed in place
+	void Update(int handle)
+	{
+		int i = PositionOf(handle);
+		mNodes[i] = MakeNode(handle,mValues[handle]);
+		Fix(i);
+	}
+	//! A function to remove the element of a handle
+	void Erase(int handle)
+	{
+		int i = PositionOf(handle);
+		mPos[handle] = 0;
+		if (i != mSize)
+		{
+			Place(i,mNodes[mSize]);
+			-- mSize;
+			Fix(i);
+		}
+		else
+		{
+			-- mSize;
+		}
+	}
+	//! A function to answer the query of the minimum element
+	TYPE PeekMin()
+	{
+		return mValues[MinHandle()];
+	}
+	//! A function to get the handle of the minimum element
+	int MinHandle()
+	{
+		if (Empty())
+			throw new std::underflow_error("KeyedMinHeap underflow.");
+		return HandleOf(mNodes[1]);
+	}
+	//! A function to remove the minimum element
+	void PopMin()
+	{
+		Erase(MinHandle());
+	}
+	//! A function to replace the minimum element by x (owned by the same handle), with a single sift
+	void ReplaceMin(TYPE x)
+	{
+		int handle = MinHandle();
+		mValues[handle] = x;
+		mNodes[1] = MakeNode(handle,x);
+		Sink(1);
+	}
+	//! A function to remove all elements
+	void Clear()
+	{
+		for (int i = 1;i <= mSize;++ i)
+			mPos[HandleOf(mNodes[i])] = 0;
+		mSize = 0;
+	}
+	//! A function to track whether the heap is empty
+	bool Empty()
+	{
+		return (mSize == 0);
+	}
+	//! A function to get the current size of the heap
+	int Size()
+	{
+		return mSize;
+	}
+	//! A function to check whether the array satisfies the minHeap property and the positions are consistent
+	bool IsMinHeap()
+	{
+		for (int i = 1;i <= mSize;++ i)
+		{
+			if (mPos[HandleOf(mNodes[i])] != i) return false;
+			if (i > 1 && mNodes[i] < mNodes[Parent(i)]) return false;
+		}
+		return true;
+	}
+	//! A function to print out the elements (with their handles) in heap order
+	void Print()
+	{
+		for (int i = 1;i <= mSize;++ i)
+			std::cout << HandleOf(mNodes[i]) << ":" << mValues[HandleOf(mNodes[i])] << " ";
+		std::cout << std::endl;
+	}
+};
+
+
+
+#endif
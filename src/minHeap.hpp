@@ -10,79 +10,348 @@
 #include <iostream>
 #include <vector>
 #include <functional> // greater
+#include <algorithm> // min
 #include <assert.h>     // assert 
 #include <stdexcept> // underflow overflow
+#include <memory> // allocator allocator_traits
+#include <utility> // swap
+#include <iterator> // distance iterator_traits move_iterator
+
+//! validation policy of the heap invariant
+enum HeapCheckMode {
+	HEAP_CHECK_OFF,     //!< never check (default)
+	HEAP_CHECK_SAMPLED, //!< check after every Nth mutating operation
+	HEAP_CHECK_FULL     //!< check after every mutating operation
+};
+
+//! description of a detected violation of the heap invariant
+struct HeapViolation {
+	//! name of the operation after which the violation was detected
+	const char *mOperation;
+	//! sequence number of that operation (counting all mutating operations)
+	long mOpCount;
+	//! index of the offending parent node
+	int mParent;
+	//! index of the child which is smaller than its parent
+	int mChild;
+	//! # of elements in the heap when the violation was detected
+	int mSize;
+};
+
+//! default violation handler, reports to std::cerr
+inline void ReportHeapViolation(const HeapViolation& v)
+{
+	std::cerr << "MinHeap invariant violated after " << v.mOperation
+	          << " (operation #" << v.mOpCount << ", size " << v.mSize
+	          << "): parent " << v.mParent << " > child " << v.mChild << std::endl;
+}
+
+//! size (in bytes) of a cache line
+const int HEAP_CACHE_LINE_SIZE = 64;
+//! default capacity of a heap
+const int HEAP_DEFAULT_CAPACITY = 100;
+
+//! The heap storage class
+/*!
+	Owns the array of a heap, allocated through Alloc. All slots are constructed
+	when allocated and destroyed when released. The array is offset so that
+	index 2 starts a cache line (when the cache line size is a multiple of sizeof(TYPE)).
+*/
+template <class TYPE,class Alloc = std::allocator<TYPE> >
+class HeapStorage{
+	typedef std::allocator_traits<Alloc> Traits;
+	//! allocator
+	Alloc mAlloc;
+	//! allocated slots (mpElements points into it)
+	TYPE *mpBuffer;
+	//! # of allocated slots
+	size_t mBufferLen;
+	//! elements, offset into mpBuffer
+	TYPE *mpElements;
+	//! # of usable slots
+	int mCapacity;
+	//! A function to allocate and construct storage for capacity slots
+	void Allocate(int capacity)
+	{
+		const size_t pad = (HEAP_CACHE_LINE_SIZE % sizeof(TYPE) == 0) ? HEAP_CACHE_LINE_SIZE / sizeof(TYPE) : 0;
+		mBufferLen = capacity + pad;
+		mpBuffer = Traits::allocate(mAlloc,mBufferLen);
+		for (size_t i = 0;i < mBufferLen;++ i)
+			Traits::construct(mAlloc,mpBuffer + i);
+		size_t offset = 0;
+		if (pad > 0)
+		{
+			size_t misalign = reinterpret_cast<size_t>(mpBuffer + 2) % HEAP_CACHE_LINE_SIZE;
+			if (misalign % sizeof(TYPE) == 0)
+				offset = (HEAP_CACHE_LINE_SIZE - misalign) % HEAP_CACHE_LINE_SIZE / sizeof(TYPE);
+		}
+		mpElements = mpBuffer + offset;
+		mCapacity = capacity;
+	}
+	//! A function to destroy and deallocate the storage
+	void Release()
+	{
+		if (mpBuffer == NULL) return;
+		for (size_t i = 0;i < mBufferLen;++ i)
+			Traits::destroy(mAlloc,mpBuffer + i);
+		Traits::deallocate(mAlloc,mpBuffer,mBufferLen);
+		mpBuffer = mpElements = NULL;
+		mBufferLen = 0;
+		mCapacity = 0;
+	}
+public:
+	//! A constructor with the # of slots specified
+	explicit HeapStorage(int capacity,const Alloc& alloc = Alloc()): mAlloc(alloc)
+	{
+		Allocate(capacity);
+	}
+	//! copy constructor
+	HeapStorage(const HeapStorage& other): mAlloc(Traits::select_on_container_copy_construction(other.mAlloc))
+	{
+		Allocate(other.mCapacity);
+		for (int i = 0;i < mCapacity;++ i)
+			mpElements[i] = other.mpElements[i];
+	}
+	//! move constructor
+	HeapStorage(HeapStorage&& other) noexcept: mAlloc(std::move(other.mAlloc))
+	{
+		mpBuffer = other.mpBuffer;
+		mBufferLen = other.mBufferLen;
+		mpElements = other.mpElements;
+		mCapacity = other.mCapacity;
+		other.mpBuffer = other.mpElements = NULL;
+		other.mBufferLen = 0;
+		other.mCapacity = 0;
+	}
+	//! copy and move assignment
+	HeapStorage& operator=(HeapStorage other) noexcept
+	{
+		Swap(other);
+		return *this;
+	}
+	//! destructor
+	~HeapStorage()
+	{
+		Release();
+	}
+	//! A function to exchange the storage with another one
+	void Swap(HeapStorage& other) noexcept
+	{
+		std::swap(mAlloc,other.mAlloc);
+		std::swap(mpBuffer,other.mpBuffer);
+		std::swap(mBufferLen,other.mBufferLen);
+		std::swap(mpElements,other.mpElements);
+		std::swap(mCapacity,other.mCapacity);
+	}
+	//! A function to move to new storage of capacity slots, keeping slots 1..count
+	void Reallocate(int capacity,int count)
+	{
+		assert(capacity >= count + 1);
+		TYPE *pOld = mpElements;
+		TYPE *pOldBuffer = mpBuffer;
+		size_t oldLen = mBufferLen;
+		Allocate(capacity);
+		for (int i = 1;i <= count;++ i)
+			mpElements[i] = std::move(pOld[i]);
+		for (size_t i = 0;i < oldLen;++ i)
+			Traits::destroy(mAlloc,pOldBuffer + i);
+		Traits::deallocate(mAlloc,pOldBuffer,oldLen);
+	}
+	//! A function to access slot i
+	inline TYPE& operator[](int i)
+	{
+		return mpElements[i];
+	}
+	//! A function to get the # of usable slots
+	int Capacity() const
+	{
+		return mCapacity;
+	}
+	//! A function to get the allocator
+	Alloc GetAllocator() const
+	{
+		return mAlloc;
+	}
+};
 
 //! The minHeap class
 /*!
- 	Generic min binary heap using an array.
+ 	Generic min d-ary heap using an array (binary by default).
 	Can be used with an customized comparator instead of the natural order,
 	but the generic Value type must still be comparable.
+	Elements are stored from index 1; the children of node i are
+	Arity * (i - 1) + 2, ..., Arity * i + 1. The array is offset so that
+	index 2 starts a cache line, hence when Arity * sizeof(TYPE) equals the
+	cache line size (e.g., Arity = 8 for pointers), all children of a node
+	are fetched with a single cache line.
+	The storage is allocated through Alloc and owned by the heap, which is
+	copyable and movable. It doubles when full and halves when a quarter full,
+	but never below the capacity requested with Reserve(), so a heap reserved
+	for its peak size never allocates again.
 */
-template <class TYPE,class Compare=std::greater<TYPE> >
+template <class TYPE,class Compare=std::greater<TYPE>,int Arity = 2,class Alloc = std::allocator<TYPE> >
 class MinHeap{
-	//! capacity of the heap
-	int mCapacity;
+	static_assert(Arity >= 2,"MinHeap fanout must be at least 2.");
 	//! # of elements
 	int mSize;
-	//! elements
-	TYPE *mpElements;
+	//! capacity below which the storage is never shrunk
+	int mMinCapacity;
+	//! elements, stored from index 1
+	HeapStorage<TYPE,Alloc> mElements;
 	//! comparison function
 	/*! The comparison function can be user-defined, if unspecified, std::greater<TYPE> would be used. 
 	*/
 	Compare mGreater; 
+	//! validation mode
+	HeapCheckMode mCheckMode;
+	//! in sampled mode, check after every mCheckPeriod-th operation
+	long mCheckPeriod;
+	//! # of mutating operations performed so far
+	long mOpCount;
+	//! # of violations detected so far
+	long mViolationCount;
+	//! the most recently detected violation
+	HeapViolation mLastViolation;
+	//! function called on every detected violation
+	std::function<void(const HeapViolation&)> mViolationHandler;
+	//! A function to set up the validation state, called by all constructors
+	void InitValidation()
+	{
+		mCheckMode = HEAP_CHECK_OFF;
+		mCheckPeriod = 1;
+		mOpCount = 0;
+		mViolationCount = 0;
+		mLastViolation = HeapViolation{"", 0, 0, 0, 0};
+		mViolationHandler = ReportHeapViolation;
+	}
+	//! A function to get the index of the parent of node i (i > 1)
+	static inline int Parent(int i)
+	{
+		return (i - 2) / Arity + 1;
+	}
+	//! A function to get the index of the first child of node i
+	static inline int FirstChild(int i)
+	{
+		return Arity * (i - 1) + 2;
+	}
 	//! A function to build a MinHeap from an unordered array
 	void BuildMinHeap()
 	{
-		for (int i = (mSize - 1) / 2 + 1;i >= 1;-- i)
+		if (mSize < 2) return;
+		for (int i = Parent(mSize);i >= 1;-- i)
 			MinHeapify(i);
 	}
+	//! A function to get the # of levels of a heap with n elements
+	static int Depth(int n)
+	{
+		int depth = 0;
+		for (long long levelEnd = 1,levelSize = 1;n > 0;levelSize *= Arity,levelEnd += levelSize)
+		{
+			++ depth;
+			if (n <= levelEnd) break;
+		}
+		return depth;
+	}
+	//! A function to restore the heap after elements were appended at positions first..mSize
+	/*! Small batches are swum up one by one. Large batches are repaired Floyd-style,
+	    sinking every ancestor of the new elements once, bottom-up, which costs
+	    O(k + log n) sift steps on average instead of O(k log n) in the worst case.
+	*/
+	void RepairAppended(int first)
+	{
+		int k = mSize - first + 1;
+		if (k <= 0) return;
+		if (k <= Depth(mSize))
+		{
+			for (int i = first;i <= mSize;++ i)
+				Swim(i);
+			return;
+		}
+		if (mSize < 2) return;
+		int lo = Parent(std::max(first,2));
+		int hi = Parent(mSize);
+		while (true)
+		{
+			for (int i = hi;i >= lo;-- i)
+				MinHeapify(i);
+			if (lo == 1) break;
+			lo = Parent(lo);
+			hi = Parent(hi);
+		}
+	}
 	//! A function to make the sub-tree rooted at node i a minHeap, if the sub-trees rooted at all its descendants are already minHeap 
+	/*! The element at i is moved down through a hole instead of being swapped at every level.
+	*/
 	void MinHeapify(int i)
 	{
-		int j;
-		while (2 * i <= mSize)
+		TYPE x = mElements[i];
+		int first,last,j;
+		while ((first = FirstChild(i)) <= mSize)
 		{
-			j = i;
-			if (mGreater(mpElements[j],mpElements[2 * i])) j = 2 * i;
-			if (2 * i + 1 <= mSize && mGreater(mpElements[j],mpElements[2 * i + 1])) j = 2 * i + 1;
-			if (j == i) break;
-			Swap(i,j);
+			last = std::min(first + Arity - 1,mSize);
+			j = first;
+			for (int c = first + 1;c <= last;++ c)
+				if (mGreater(mElements[j],mElements[c])) j = c;
+			if (!mGreater(x,mElements[j])) break;
+			mElements[i] = mElements[j];
 			i = j;
 		}
+		mElements[i] = x;
 	}
-	//! A function to exchange mpElements[i] and mpElements[j]
+	//! A function to exchange mElements[i] and mElements[j]
 	inline void Swap(int i,int j)
 	{
-		TYPE tmp = mpElements[i];
-		mpElements[i] = mpElements[j];
-		mpElements[j] = tmp;
+		TYPE tmp = mElements[i];
+		mElements[i] = mElements[j];
+		mElements[j] = tmp;
 	}
 	//! A function to check whether the array satisfies the minHeap property or not
-	bool IsMinHeap()
+	/*! On failure, the indices of the first offending parent/child pair are stored in pParent/pChild (if given).
+	*/
+	bool IsMinHeap(int *pParent = NULL,int *pChild = NULL)
 	{
-		if (Empty()) return true;
-		for (int i = 1;2 * i <= mSize;++ i)
+		for (int j = 2;j <= mSize;++ j)
+			if (mGreater(mElements[Parent(j)],mElements[j]))
 			{
-				if (mGreater(mpElements[i],mpElements[2 * i])) return false;
-				if (2 * i + 1 <= mSize && mGreater(mpElements[i],mpElements[2 * i + 1])) return false;
+				if (pParent) *pParent = Parent(j);
+				if (pChild) *pChild = j;
+				return false;
 			}
 		return true;
 	}
+	//! A function to validate the heap after a mutating operation according to the validation mode
+	void Validate(const char *operation)
+	{
+		++ mOpCount;
+		if (mCheckMode == HEAP_CHECK_OFF) return;
+		if (mCheckMode == HEAP_CHECK_SAMPLED && mOpCount % mCheckPeriod != 0) return;
+		Check(operation);
+	}
+	//! A function to scan the whole heap and report the first violation found, if any
+	bool Check(const char *operation)
+	{
+		int parent,child;
+		if (IsMinHeap(&parent,&child)) return true;
+		mLastViolation = HeapViolation{operation, mOpCount, parent, child, mSize};
+		++ mViolationCount;
+		if (mViolationHandler) mViolationHandler(mLastViolation);
+		return false;
+	}
 	//! A function to make the minHeap still satisfy the minHeap property when inserting a node at i.
 	void Swim(int i)
 	{
+		TYPE x = mElements[i];
 		int parent;
 		while (i > 1)
 		{
-			parent = i / 2;
-			if (mGreater(mpElements[parent],mpElements[i]))
-				Swap(parent,i);
+			parent = Parent(i);
+			if (mGreater(mElements[parent],x))
+				mElements[i] = mElements[parent];
 			else
 				break;
 			i = parent;
 		}
-
+		mElements[i] = x;
 	}
 	//! The same as MinHeapify()
 	void Sink(int i)
@@ -92,57 +361,95 @@ class MinHeap{
 
 public:
 	//! A constructor
-	explicit MinHeap(Compare uGreater = Compare())// constructor
+	explicit MinHeap(Compare uGreater = Compare(),const Alloc& alloc = Alloc())// constructor
+		: mElements(HEAP_DEFAULT_CAPACITY,alloc)
 	{
-		mCapacity = 100;
 		mSize = 0;
-		mpElements = new TYPE[mCapacity];
+		mMinCapacity = 1;
 		mGreater = uGreater;
+		InitValidation();
 	}
-	//! A constructor with mCapacity specified
-	explicit MinHeap(int capacity,Compare uGreater = Compare())// constructor
+	//! A constructor with capacity specified
+	explicit MinHeap(int capacity,Compare uGreater = Compare(),const Alloc& alloc = Alloc())// constructor
+		: mElements(capacity + 1,alloc)
 	{
-		mCapacity = capacity + 1;
 		mSize = 0;
-		mpElements = new TYPE[mCapacity];
+		mMinCapacity = 1;
 		mGreater = uGreater;
+		InitValidation();
+	}
+	//! A constructor from a range [first,last) of forward iterators, built in O(n)
+	template <class ForwardIt,class = typename std::iterator_traits<ForwardIt>::iterator_category>
+	MinHeap(ForwardIt first,ForwardIt last,Compare uGreater = Compare(),const Alloc& alloc = Alloc())// constructor
+		: mElements(std::distance(first,last) + 1,alloc)
+	{
+		mSize = 0;
+		mMinCapacity = 1;
+		for (;first != last;++ first)
+			mElements[++ mSize] = *first;
+
+		mGreater = uGreater;
+		InitValidation();
+		BuildMinHeap();
 	}
 	//! A constructor
-	explicit MinHeap(TYPE *data,int len,Compare uGreater = Compare())// constructor
+	explicit MinHeap(TYPE *data,int len,Compare uGreater = Compare(),const Alloc& alloc = Alloc())// constructor
+		: MinHeap(data,data + len,uGreater,alloc)
 	{
-		std::vector<TYPE> vecData(data,data + len);
-		MinHeap(vecData,uGreater);
 	}
 	//! A constructor
-	explicit MinHeap(std::vector<TYPE>& data, Compare uGreater = Compare())// constructor
+	explicit MinHeap(const std::vector<TYPE>& data, Compare uGreater = Compare(),const Alloc& alloc = Alloc())// constructor
+		: MinHeap(data.begin(),data.end(),uGreater,alloc)
 	{
-		mSize = data.size();
-		mCapacity = mSize + 1;
-		mpElements = new TYPE[mCapacity];
-		for (int i = 1;i <= mSize;++ i)
-			mpElements[i] = data[i - 1];
-
+	}
+	//! A constructor moving the elements out of data
+	explicit MinHeap(std::vector<TYPE>&& data, Compare uGreater = Compare(),const Alloc& alloc = Alloc())// constructor
+		: MinHeap(std::make_move_iterator(data.begin()),std::make_move_iterator(data.end()),uGreater,alloc)
+	{
+	}
+	//! A constructor adopting a buffer whose slots 1..size hold the elements (in any order), built in O(n)
+	explicit MinHeap(HeapStorage<TYPE,Alloc>&& storage,int size,Compare uGreater = Compare())// constructor
+		: mElements(std::move(storage))
+	{
+		if (size < 0 || size > mElements.Capacity() - 1)
+			throw new std::out_of_range("Adopted heap buffer is too small.");
+		mSize = size;
+		mMinCapacity = 1;
 		mGreater = uGreater;
+		InitValidation();
 		BuildMinHeap();
-		assert(IsMinHeap()); // please comment this line when using
 	}
 	//! A function to print out the elements in the heap
 	void Print()
 	{
 		for (int i = 1;i <= mSize;++ i)
 		{
-	        std::cout << mpElements[i] << " ";
+	        std::cout << mElements[i] << " ";
 		}
 		std::cout << std::endl;
 	}
 	//! A function to insert a value in the heap
 	void Insert(TYPE x)
 	{
-		if (mSize >= mCapacity - 1) Resize(2 * mCapacity);
+		if (mSize >= Capacity()) Resize(2 * (Capacity() + 1));
 		++ mSize;
-		mpElements[mSize] = x;
+		mElements[mSize] = x;
         Swim(mSize);
-        assert(IsMinHeap());// please comment this line when using
+        Validate("Insert");
+	}
+	//! A function to insert the elements of a range [first,last) of forward iterators at once
+	/*! Storage grows at most once, and a large batch is repaired Floyd-style in O(n) instead of O(k log n).
+	*/
+	template <class ForwardIt>
+	void InsertRange(ForwardIt first,ForwardIt last)
+	{
+		int k = std::distance(first,last);
+		if (mSize + k > Capacity()) Resize(std::max(mSize + k + 1,2 * (Capacity() + 1)));
+		int firstNew = mSize + 1;
+		for (;first != last;++ first)
+			mElements[++ mSize] = *first;
+		RepairAppended(firstNew);
+		Validate("InsertRange");
 	}
 	//! A function to answer the query of the minimum element in the heap
 	TYPE Min()
@@ -151,7 +458,7 @@ public:
         {
         	throw new std::underflow_error("MaxHeap underflow.");
         }
-        return mpElements[1];
+        return mElements[1];
 	}
     //! A function to answer the query of the minimum element in the heap amd then remove the minimum element 
 	TYPE ExtractMin()
@@ -169,31 +476,90 @@ public:
 		    -- mSize;
 		}
 
-		assert(IsMinHeap()); // please comment this line when using
-		if (mSize > 0 && mSize == (mCapacity - 1) / 4) Resize(mCapacity / 2);
+		Validate("ExtractMin");
+		//! hysteresis: grown at full, shrunk at a quarter, so the size must change 2x between reallocations
+		int slots = Capacity() + 1;
+		if (mSize > 0 && mSize <= (slots - 1) / 4 && slots / 2 >= mMinCapacity) Resize(slots / 2);
 
 		return minElem;
 	}
+	//! A function to replace the minimum element by x, with a single sift instead of ExtractMin() + Insert()
+	void ReplaceMin(TYPE x)
+	{
+		Min();
+		mElements[1] = x;
+		Sink(1);
+		Validate("ReplaceMin");
+	}
     //! A function to track whether the heap is empty
 	bool Empty()
 	{
 		return (mSize == 0);
 	}
-    //! A function to change the mCapacity of the heap
+    //! A function to change the # of slots of the heap (one more than its capacity)
 	void Resize(int capacity)
 	{
 		assert(capacity >= mSize + 1);
-        mCapacity = capacity;
-        TYPE *tmp = new TYPE[mCapacity];
-        for (int i = 1;i <= mSize;++ i)
-        	tmp[i] = mpElements[i];
-        mpElements = tmp;
+		mElements.Reallocate(capacity,mSize);
+	}
+	//! A function to make room for n elements, and never shrink below that afterwards
+	void Reserve(int n)
+	{
+		if (n + 1 > mElements.Capacity()) Resize(n + 1);
+		mMinCapacity = std::max(mMinCapacity,n + 1);
+	}
+	//! A function to drop the reservation and release the unused capacity
+	void ShrinkToFit()
+	{
+		mMinCapacity = 1;
+		if (mElements.Capacity() > mSize + 1) Resize(mSize + 1);
+	}
+	//! A function to get the # of elements the heap can hold without reallocation
+	int Capacity()
+	{
+		return mElements.Capacity() - 1;
+	}
+	//! A function to get the allocator
+	Alloc GetAllocator()
+	{
+		return mElements.GetAllocator();
 	}
 	//! A function to get the current size of the minHeap
 	int Size()
 	{
 		return mSize;
 	}
+	//! A function to select the validation mode
+	/*! In HEAP_CHECK_SAMPLED mode the invariant is checked after every period-th mutating operation,
+	    which amortizes the O(n) scan to O(n / period) per operation.
+	*/
+	void SetCheckMode(HeapCheckMode mode,long period = 1)
+	{
+		if (period < 1)
+			throw new std::invalid_argument("Heap check period must be positive.");
+		mCheckMode = mode;
+		mCheckPeriod = period;
+	}
+	//! A function to replace the handler called on every detected violation (NULL to only count)
+	void SetViolationHandler(std::function<void(const HeapViolation&)> handler)
+	{
+		mViolationHandler = handler;
+	}
+	//! A function to check the invariant right now regardless of the validation mode
+	bool CheckNow()
+	{
+		return Check("CheckNow");
+	}
+	//! A function to get the # of violations detected so far
+	long ViolationCount()
+	{
+		return mViolationCount;
+	}
+	//! A function to get the most recently detected violation
+	HeapViolation LastViolation()
+	{
+		return mLastViolation;
+	}
 };
 
 
@@ -2,42 +2,51 @@
 #define PACKET_HPP
 
 #include <iostream>
-#include <queue>
+#include <vector>
+#include <utility> // pair
+#include <algorithm> // sort
+#include <stdint.h> // uint32_t uint64_t
+#include <stdexcept> // runtime_error length_error out_of_range
+#include "virtualTime.hpp"
+#include "ringQueue.hpp"
+#include "flowTable.hpp" // FlowTable FlowId
+#include "hugePages.hpp" // HugePageAllocator
 
 /* default flow weight */
 const double DEF_FLOW_WEIGHT = 1.0;
 
-//! declaration for flow class
-class Flow;
+//! maximum packet length in bytes, as stored in the 16-bit length column of a PacketTable
+const int MAX_PACKET_LENGTH = 65535;
 
 //! packet class
+/*!
+	A row of a PacketTable, which stores packets by column. The flow is found
+	by id through the flow table of the PacketTable, which the simulator
+	indexes its flows by.
+*/
 class Packet{
 public:	
 	//! which flow the packet belongs to
-	int mFlowId;
+	FlowId mFlowId;
 	//! the index of current packet 
 	int mPacketId;
 	//! size (in terms of bytes) of this packet
 	int mLength;
 	//! GPS virtual finish time for this packet
-	double mGPS_VFTime; 
-	//! real arrival time of this packet
-	long int mArrivalTime;
-	//! the flow the packet belongs to
-	Flow *mpFlow; 
+	VTime mGPS_VFTime; 
+	//! real arrival time of this packet, in nanoseconds
+	RTime mArrivalTime;
+	//! real time at which GPS finishes serving this packet, in nanoseconds (-1 until it departs)
+	RTime mGPS_DepartureTime;
 	//! constructor
-	Packet(int flowId,int pktId,int pktSize,long int arrivalTime)
+	Packet(FlowId flowId,int pktId,int pktSize,RTime arrivalTime)
 	{
 		mFlowId = flowId;
 		mPacketId = pktId;
 		mLength = pktSize;
 		mArrivalTime = arrivalTime;
-		mpFlow = NULL;
-	}
-	//! set the flow to which this packet belongs
-	void SetFlow(Flow *f)
-	{
-		mpFlow = f;
+		mGPS_VFTime = 0;
+		mGPS_DepartureTime = -1;
 	}
 	//! define less than function
 	friend bool operator<(Packet &cPacket1,Packet  &cPacket2)
@@ -46,67 +55,315 @@ public:
 	}
 };
 
+//! index of a packet in a PacketTable
+typedef uint32_t PacketIndex;
+//! maximum # of packets of a PacketTable
+const size_t MAX_PACKET_NUM = UINT32_MAX;
+//! column of a PacketTable
+template <class T>
+using PacketColumn = std::vector<T,HugePageAllocator<T> >;
+
+//! columnar table of packets
+/*!
+	Every field of the packets is a column indexed by PacketIndex, so that
+	scans reading a few fields (sorting by arrival time, simulation, output)
+	touch only those columns, and flows and simulators refer to packets by
+	32-bit index rather than by pointer. Packet is the row type.
+	Flow ids are dictionary-encoded: a FlowTable gives each id a dense flow
+	index on first sight, which the packets store instead of the id.
+	Lengths are stored in 16 bits: Append() rejects longer packets. A packet
+	takes ROW_BYTES = 34 bytes, checked at compile time.
+	With hugePages, columns of at least HUGE_PAGE_BYTES are backed by huge
+	pages (see HugePageAllocator). Reserve() sizes every column in one
+	allocation when the # of packets is known beforehand.
+*/
+class PacketTable{
+	//! A function to reorder a column so that row i is the old row order[i].second
+	template <class T>
+	static void Permute(PacketColumn<T>& column,const std::vector<std::pair<RTime,PacketIndex> >& order)
+	{
+		PacketColumn<T> permuted(column.size(),T(),column.get_allocator());
+		for (size_t i = 0;i < order.size();++ i)
+			permuted[i] = column[order[i].second];
+		column.swap(permuted);
+	}
+	//! flow index of each flow id seen
+	FlowTable mFlowIds;
+public:
+	//! index of the flow the packet belongs to, see FlowIndexOf()
+	PacketColumn<int32_t> mFlowIndex;
+	//! the index of the packet in its flow
+	PacketColumn<int32_t> mPacketId;
+	//! size (in terms of bytes) of the packet
+	PacketColumn<uint16_t> mLength;
+	//! real arrival time of the packet, in nanoseconds
+	PacketColumn<RTime> mArrivalTime;
+	//! GPS virtual finish time of the packet
+	PacketColumn<VTime> mGPS_VFTime;
+	//! real time at which GPS finishes serving the packet, in nanoseconds (-1 until it departs)
+	PacketColumn<RTime> mGPS_DepartureTime;
+	//! # of bytes a packet takes in the columns
+	static constexpr size_t ROW_BYTES = sizeof(decltype(mFlowIndex)::value_type)
+		+ sizeof(decltype(mPacketId)::value_type) + sizeof(decltype(mLength)::value_type)
+		+ sizeof(decltype(mArrivalTime)::value_type) + sizeof(decltype(mGPS_VFTime)::value_type)
+		+ sizeof(decltype(mGPS_DepartureTime)::value_type);
+	static_assert(ROW_BYTES == 34,"A packet must take 34 bytes in the columns of a PacketTable.");
+	//! constructor, backing large columns by huge pages if hugePages
+	explicit PacketTable(bool hugePages = false)
+		: mFlowIndex(HugePageAllocator<int32_t>(hugePages)),
+		  mPacketId(HugePageAllocator<int32_t>(hugePages)),
+		  mLength(HugePageAllocator<uint16_t>(hugePages)),
+		  mArrivalTime(HugePageAllocator<RTime>(hugePages)),
+		  mGPS_VFTime(HugePageAllocator<VTime>(hugePages)),
+		  mGPS_DepartureTime(HugePageAllocator<RTime>(hugePages))
+	{
+	}
+	//! append a packet, return its index
+	PacketIndex Append(const Packet& pkt)
+	{
+		if (Size() >= MAX_PACKET_NUM)
+			throw new std::length_error("Too many packets for 32-bit packet indices.");
+		if (pkt.mLength < 0 || pkt.mLength > MAX_PACKET_LENGTH)
+			throw new std::out_of_range("Packet length must be in [0,65535] bytes to fit the 16-bit length column.");
+		mFlowIndex.push_back(FlowIndexOf(pkt.mFlowId));
+		mPacketId.push_back(pkt.mPacketId);
+		mLength.push_back((uint16_t) pkt.mLength);
+		mArrivalTime.push_back(pkt.mArrivalTime);
+		mGPS_VFTime.push_back(pkt.mGPS_VFTime);
+		mGPS_DepartureTime.push_back(pkt.mGPS_DepartureTime);
+		return (PacketIndex) (Size() - 1);
+	}
+	//! get packet i as a row
+	Packet Get(PacketIndex i) const
+	{
+		Packet pkt(FlowIdOf(i),mPacketId[i],mLength[i],mArrivalTime[i]);
+		pkt.mGPS_VFTime = mGPS_VFTime[i];
+		pkt.mGPS_DepartureTime = mGPS_DepartureTime[i];
+		return pkt;
+	}
+	//! get the flow index of flow id, giving the flow the next index if it was never seen
+	int FlowIndexOf(FlowId id)
+	{
+		return mFlowIds.IndexOf(id);
+	}
+	//! get the flow index of flow id, -1 if it was never seen
+	int FindFlow(FlowId id) const
+	{
+		return mFlowIds.Find(id);
+	}
+	//! get the flow id of packet i
+	FlowId FlowIdOf(PacketIndex i) const
+	{
+		return mFlowIds.IdOf(mFlowIndex[i]);
+	}
+	//! get the # of flows seen
+	int FlowNum() const
+	{
+		return mFlowIds.Size();
+	}
+	//! get the # of packets
+	size_t Size() const
+	{
+		return mFlowIndex.size();
+	}
+	//! make room for n packets, so that appending up to n packets moves no column
+	void Reserve(size_t n)
+	{
+		mFlowIndex.reserve(n);
+		mPacketId.reserve(n);
+		mLength.reserve(n);
+		mArrivalTime.reserve(n);
+		mGPS_VFTime.reserve(n);
+		mGPS_DepartureTime.reserve(n);
+	}
+	//! check whether there is no packet
+	bool Empty() const
+	{
+		return mFlowIndex.empty();
+	}
+	//! sort the packets by arrival time
+	/*! Sorts (arrival time, index) pairs with std::sort, which orders packets
+	    arriving at the same time exactly as sorting Packet pointers in index
+	    order did, then reorders the columns one at a time unless they are
+	    already sorted.
+	*/
+	void SortByArrivalTime()
+	{
+		std::vector<std::pair<RTime,PacketIndex> > order(Size());
+		for (size_t i = 0;i < order.size();++ i)
+			order[i] = std::make_pair(mArrivalTime[i],(PacketIndex) i);
+		std::sort(order.begin(),order.end(),[](const std::pair<RTime,PacketIndex>& a,const std::pair<RTime,PacketIndex>& b) { return a.first < b.first; });
+		bool inOrder = true;
+		for (size_t i = 0;i < order.size() && inOrder;++ i)
+			inOrder = (order[i].second == i);
+		if (inOrder) return;
+		Permute(mFlowIndex,order);
+		Permute(mPacketId,order);
+		Permute(mLength,order);
+		Permute(mArrivalTime,order);
+		Permute(mGPS_VFTime,order);
+		Permute(mGPS_DepartureTime,order);
+	}
+};
+
 //! flow class
 class Flow{
 public:
 	//! weight of this flow
 	double mWeight;    
+	//! virtual time per byte (reciprocal of the weight), so that virtual service times need no division
+	VTimeOps<VTime>::Rate mInvWeight;
     //! size of this flow (in terms of bytes)
 	int mLength;
-	//! packets in this flow
-	std::queue<Packet *> mPackets;
+	//! packets in this flow, by index in the packet table of the simulator
+	RingQueue<PacketIndex> mPackets;
 	//! record the virtual finish time of the last packet in this flow
-	double mLastPacketVFTime;
+	VTime mLastPacketVFTime;
+	//! busy period of the simulator in which mLastPacketVFTime was last valid
+	uint64_t mEpoch;
 	//! constructor
 	Flow(double weight = DEF_FLOW_WEIGHT)
 	{
 		if (weight <= 0)
 			throw new std::runtime_error("Cannot create flow with negative or zero weight.");
 		mWeight = weight;
+		mInvWeight = VTimeOps<VTime>::PerByte(weight);
 		mLength = 0;
-		mLastPacketVFTime = 0.0;
+		mLastPacketVFTime = 0;
+		mEpoch = 0;
 	}
-	//! insert a packet
-	void AppendPacket(Packet *pkt){
-		mPackets.push(pkt);
-		mLength += pkt->mLength;
-		mLastPacketVFTime = pkt->mGPS_VFTime;
+	//! bring the flow into busy period epoch of the simulator
+	/*! Virtual time restarts from 0 with every busy period, so the virtual finish
+	    time of a flow last touched in an earlier one is stale and reset here,
+	    the first time the flow is touched again, rather than for every flow when
+	    the busy period ends.
+	*/
+	inline void Renew(uint64_t epoch)
+	{
+		if (mEpoch != epoch)
+		{
+			mEpoch = epoch;
+			mLastPacketVFTime = 0;
+		}
+	}
+	//! insert packet i of the table
+	void AppendPacket(PacketIndex i,const PacketTable& packets){
+		mPackets.Push(i);
+		mLength += packets.mLength[i];
+		mLastPacketVFTime = packets.mGPS_VFTime[i];
 	}
 	//! remove the currently first packet (i.e., head of line packet)
 	void PopHOL()
 	{
-		if (mPackets.empty())
+		if (mPackets.Empty())
 			throw new std::runtime_error("Cannot pop HOL packet from an empty flow.");
-		mPackets.pop();
+		mPackets.Pop();
 	}
-	//! get the currently head of line packet	
-	Packet* PeekHOL()
+	//! get the currently head of line packet, prefetching the finish time of the next one
+	/*! The next packet becomes head of line when this one departs, and its
+	    finish time is read then to requeue the flow.
+	*/
+	PacketIndex PeekHOL(const PacketTable& packets)
 	{
-		if (mPackets.empty())
+		if (mPackets.Empty())
 			throw new std::runtime_error("Cannot peek HOL packet from an empty flow.");
-		return mPackets.front();
+#if defined(__GNUC__)
+		if (mPackets.Size() > 1)
+			__builtin_prefetch(&packets.mGPS_VFTime[mPackets.At(1)]);
+#endif
+		return mPackets.Front();
 	}
 	//! get the status of this flow
 	bool IsBackloggedUnderGPS()
 	{
-		return !mPackets.empty();
+		return !mPackets.Empty();
 	}
 	//! get the virtual finish time of last packet in this flow
-	double GetLastPacketVFTime()
+	VTime GetLastPacketVFTime()
 	{
 		return mLastPacketVFTime;
 	}
+	//! drop all queued packets
+	void Clear()
+	{
+		mPackets.Clear();
+		mLength = 0;
+		mLastPacketVFTime = 0;
+	}
+	//! change the weight at virtual time nowVTime and recompute the virtual finish times of the queued packets
+	/*!
+		The remaining service of the HOL packet at nowVTime, (VFT - nowVTime) * old weight,
+		is finished at the new weight; each following packet finishes length / weight later.
+	*/
+	void SetWeight(double weight,VTime nowVTime,PacketTable& packets)
+	{
+		if (weight <= 0)
+			throw new std::runtime_error("Cannot set negative or zero weight to a flow.");
+		VTimeOps<VTime>::Rate invWeight = VTimeOps<VTime>::PerByte(weight);
+		size_t n = mPackets.Size();
+		VTime lastVFTime = nowVTime;
+		for (size_t k = 0;k < n;++ k)
+		{
+			PacketIndex i = mPackets.At(k);
+			if (k == 0)
+				packets.mGPS_VFTime[i] = nowVTime + VTimeOps<VTime>::Rescale(packets.mGPS_VFTime[i] - nowVTime,mWeight,weight);
+			else
+				packets.mGPS_VFTime[i] = lastVFTime + VTimeOps<VTime>::Service(packets.mLength[i],invWeight);
+			CheckFinishTime(packets.mGPS_VFTime[i]);
+			lastVFTime = packets.mGPS_VFTime[i];
+		}
+		if (n > 0) mLastPacketVFTime = lastVFTime;
+		mWeight = weight;
+		mInvWeight = invWeight;
+	}
+};
+
+//! head of line packet of a flow, as kept in the HOL priority queue of GPSSim
+/*! Carries its own finish time, so that the queue orders entries without
+    reading the packet table.
+*/
+struct HOLPacket{
+	//! GPS virtual finish time of the packet
+	VTime mGPS_VFTime;
+	//! index of the packet in the packet table
+	PacketIndex mPacket;
+	//! index of its flow
+	int mFlowIndex;
+};
+
+//! compare class based on HOL packet's virtual finish time, ties broken by flow
+class HOL_Compare_VFT_G {
+   public:
+      bool operator()(const HOLPacket& p1,const HOLPacket& p2)
+      {
+         if (p1.mGPS_VFTime != p2.mGPS_VFTime) return p1.mGPS_VFTime > p2.mGPS_VFTime;
+         return p1.mFlowIndex > p2.mFlowIndex;
+      }
+};
+
+//! key class giving HOL packet's virtual finish time, for key-based priority queues
+class HOL_Key_VFT {
+   public:
+      VTime operator()(const HOLPacket& p) { return p.mGPS_VFTime; }
 };
 
 //! compare class based on packet's virtual finish time
+/*! Ties are broken by flow id, so that the order of head of line packets is total
+    and every priority queue backend departs them in the same order.
+*/
 class PKT_Compare_VFT_G { // simple comparison function
    public:
-      bool operator()(const Packet* p1,const Packet* p2) { return p1->mGPS_VFTime > p2->mGPS_VFTime; } 
+      bool operator()(const Packet* p1,const Packet* p2)
+      {
+         if (p1->mGPS_VFTime != p2->mGPS_VFTime) return p1->mGPS_VFTime > p2->mGPS_VFTime;
+         return p1->mFlowId > p2->mFlowId;
+      }
 };
 
-//! compare class based on packet arrival time
-class PKT_Compare_AT_L { // simple comparison function
+//! key class giving packet's virtual finish time, for key-based priority queues
+class PKT_Key_VFT {
    public:
-      bool operator()(const Packet* p1,const Packet* p2) { return p1->mArrivalTime < p2->mArrivalTime; } 
+      VTime operator()(const Packet* p) { return p->mGPS_VFTime; }
 };
+
 #endif
\ No newline at end of file
@@ -5,33 +5,126 @@
 #include <fstream>
 #include <vector>
 #include <string> // for string & getline
+#include <string.h> // for memchr
+#include <thread>
+#include <atomic>
+#include <memory> // for unique_ptr
+#include <exception> // for exception_ptr
 
 //#include "packet.hpp"
-#include "GPSsim.hpp" // for Packet, Flow, GPSSim 
+#include "GPSsim.hpp" // for Packet, PacketTable, Flow, GPSSim 
 #include "json.hpp"
 
 using json = nlohmann::json;
+
+//! minimum # of packets of a segment simulated by one thread of simulateParallel()
+const size_t MIN_SEGMENT_PACKETS = 4096;
+//! # of segments per thread of simulateParallel(), to balance uneven busy periods
+const int SEGMENTS_PER_THREAD = 4;
+
 //! packet scheduler class
 class PacketScheduler{
-    GPSSim *GPSsimulator;
-    //! vector for Packets
-    std::vector<Packet *> mPackets;
+    //! simulator of a trace with any flow weights, NULL if the weights are equal
+    GPSSim<> *GPSsimulator;
+    //! simulator of a trace declaring equal weights ("f <n> eq"), NULL otherwise
+    GPSSim<0,EqualWeights> *EqGPSsimulator;
+    //! table of the packets, in arrival order
+    PacketTable mPackets;
     std::vector<double> mFlowWeights;
+    //! link rate in bytes per second ("l <bytes/sec>"), DEFAULT_LINK_RATE if not declared
+    double mLinkRate;
     json Packet2JSON(int i)
     {
-       assert(i >=0 && i < mPackets.size());
+       assert(i >=0 && i < mPackets.Size());
        json j = {
-        {"flowId",mPackets[i]->mFlowId},
-        {"packetId",mPackets[i]->mPacketId},
-        {"arrivalTime",mPackets[i]->mArrivalTime},
-        {"packetLength",mPackets[i]->mLength},
-        {"virtualFinishTime",mPackets[i]->mGPS_VFTime}
+        {"flowId",mPackets.FlowIdOf(i)},
+        {"packetId",mPackets.mPacketId[i]},
+        {"arrivalTime",mPackets.mArrivalTime[i]},
+        {"packetLength",mPackets.mLength[i]},
+        {"virtualFinishTime",VTimeOps<VTime>::ToDouble(mPackets.mGPS_VFTime[i])},
+        {"departureTime",mPackets.mGPS_DepartureTime[i]}
        };
        return j;
     }
+    //! function to split the packets into segments starting when the link is idle
+    /*!
+        GPS is work conserving, so the link is busy exactly while the fluid
+        finish time of the work arrived so far, max(finish,arrival) + length at
+        the link rate, is ahead of the arrivals. A segment starts at an arrival
+        later than this finish time, with one nanosecond of slack per packet of
+        the busy period for the rounding of departure times, and holds at least
+        minPackets packets. Returns the first packet of every segment followed
+        by the # of packets.
+    */
+    std::vector<size_t> FindSegments(size_t minPackets)
+    {
+        std::vector<size_t> starts(1,0);
+        double nsPerByte = NS_PER_SEC / mLinkRate;
+        double finish = 0;
+        size_t busyPackets = 0;
+        for (size_t i = 0;i < mPackets.Size();++ i)
+        {
+            double arrival = (double) mPackets.mArrivalTime[i];
+            if (i > 0 && arrival > finish + busyPackets + 1)
+            {
+                if (i - starts.back() >= minPackets)
+                    starts.push_back(i);
+                busyPackets = 0;
+            }
+            finish = std::max(finish,arrival) + mPackets.mLength[i] * nsPerByte;
+            ++ busyPackets;
+        }
+        starts.push_back(mPackets.Size());
+        return starts;
+    }
+    //! function to read the link rate declaration following 'l'
+    void ReadLinkRate(std::ifstream& infile)
+    {
+        std::string lines;
+        if (!(infile >> mLinkRate) || !(mLinkRate > 0))
+            throw new std::runtime_error("Missing or wrong link rate.");
+        std::getline(infile,lines);
+    }
+    //! function to count the packet lines of a trace, i.e., lines starting with 'p'
+    /*!
+        A quick pass over the file in large blocks, so that the packet table
+        is reserved once rather than grown by copying while parsing.
+    */
+    static size_t CountPackets(const std::string& input)
+    {
+        std::ifstream infile(input,std::ios::binary);
+        std::vector<char> block(1 << 20);
+        size_t count = 0;
+        bool lineStart = true;
+        while (infile.read(block.data(),block.size()) || infile.gcount() > 0)
+        {
+            const char *p = block.data(),*end = p + infile.gcount();
+            while (p < end)
+            {
+                if (lineStart)
+                {
+                    if (*p == ' ' || *p == '\t' || *p == '\r')
+                    {
+                        ++ p;
+                        continue;
+                    }
+                    count += (*p == 'p');
+                    lineStart = false;
+                }
+                //! skip to the next line
+                const char *newline = (const char *) memchr(p,'\n',end - p);
+                if (newline == NULL) break;
+                p = newline + 1;
+                lineStart = true;
+            }
+        }
+        return count;
+    }
 public:
-    //! constructor
-    PacketScheduler(std::string input){
+    //! constructor, backing the packet table by huge pages if hugePages
+    PacketScheduler(std::string input,bool hugePages = false)
+        : mPackets(hugePages)
+    {
         // input file stream
         std::ifstream infile;
         std::string lines;
@@ -41,14 +134,17 @@ public:
         std::string flowWeightConf;
         bool isEqualWeight;
         double flowWeight;
-        int flowId, packetId, packetLength;
-        long int arrivalTime;
+        FlowId flowId;
+        int packetId, packetLength;
+        RTime arrivalTime;
         char c;
+        mLinkRate = DEFAULT_LINK_RATE;
         
         // start processing input file
         try {
             
-            //! open the file
+            //! reserve the packet table, then open the file
+            mPackets.Reserve(CountPackets(input));
             infile.open (input);
             
             //! try to read flow configuration
@@ -72,6 +168,9 @@ public:
                     case 'c':// comments
                         std::getline(infile, lines);// skip this line
                         break;
+                    case 'l':// link rate
+                        ReadLinkRate(infile);
+                        break;
                     default:// unknown
                         throw new std::runtime_error("Unknown declaration.");
                 }
@@ -96,6 +195,9 @@ public:
                         case 'c':
                             std::getline(infile,lines);
                             break;
+                        case 'l':// link rate
+                            ReadLinkRate(infile);
+                            break;
                         default:
                             throw new std::runtime_error("Unknown declaration.");
                     }
@@ -109,7 +211,11 @@ public:
                 for (int i = 0;i < flowNum;++ i)
                     mFlowWeights.push_back(1.0);
             }
-            
+
+            // flows declared above are ids 1 to flowNum, in this order; any other id gets a flow of default weight on first sight
+            for (int i = 1;i <= flowNum;++ i)
+                mPackets.FlowIndexOf(i);
+
             // readmPackets
             while (!infile.eof() && infile >> c)
                 switch(c)
@@ -118,8 +224,7 @@ public:
                     {
                         if (infile >> flowId >> packetId >> arrivalTime >> packetLength)
                         {
-                            Packet *p = new Packet(flowId,packetId,packetLength,arrivalTime);
-                            mPackets.push_back(p);
+                            mPackets.Append(Packet(flowId,packetId,packetLength,arrivalTime));
                         }
                         else throw new std::runtime_error("Missing or wrong packet description.");
                         std::getline(infile,lines);
@@ -128,11 +233,14 @@ public:
                     case 'c':// comments
                         std::getline(infile,lines);
                         break;
+                    case 'l':// link rate
+                        ReadLinkRate(infile);
+                        break;
                     default:// unknown
                         throw new std::runtime_error("Unknown declaration.");
                 }
                 
-                if (mPackets.empty())// no packet was found
+                if (mPackets.Empty())// no packet was found
                     throw new std::runtime_error("MissingmPackets description.");
                 
         }
@@ -145,15 +253,22 @@ public:
         }
         
         infile.close();
-        PKT_Compare_AT_L pc;
-        std::sort(mPackets.begin(),mPackets.end(),pc);
+        mPackets.SortByArrivalTime();
 
+        GPSsimulator = NULL;
+        EqGPSsimulator = NULL;
         if (isEqualWeight)
-            GPSsimulator = new GPSSim(flowNum);
+            EqGPSsimulator = new GPSSim<0,EqualWeights>(&mPackets,flowNum,mLinkRate);
         else
-            GPSsimulator = new GPSSim(mFlowWeights);
+            GPSsimulator = new GPSSim<>(&mPackets,mFlowWeights,mLinkRate);
 
     }
+    //! destructor
+    ~PacketScheduler()
+    {
+        delete GPSsimulator;
+        delete EqGPSsimulator;
+    }
     //! function to show all flows and packets
     void print()
     {
@@ -161,6 +276,7 @@ public:
         std::cout << "                        Flow Information                           \n";
         std::cout << "===================================================================\n"; 
         std::cout << "flow number: " << mFlowWeights.size() << std::endl;
+        std::cout << "link rate: " << mLinkRate << " bytes/sec" << std::endl;
         int flowId = 1;
         for (auto f: mFlowWeights)
         {
@@ -175,45 +291,136 @@ public:
         std::cout << "===================================================================\n";
         std::cout << "                        Packet Information                         \n";
         std::cout << "===================================================================\n";
-        for (auto pkt: mPackets)
-            std::cout << "arrival time: " << pkt->mArrivalTime 
-                      << ", flow ID: " << pkt->mFlowId
-                      << ", packet ID: " << pkt->mPacketId
-                      << ", packet length: " << pkt->mLength
+        for (size_t i = 0;i < mPackets.Size();++ i)
+            std::cout << "arrival time: " << mPackets.mArrivalTime[i] 
+                      << ", flow ID: " << mPackets.FlowIdOf(i)
+                      << ", packet ID: " << mPackets.mPacketId[i]
+                      << ", packet length: " << mPackets.mLength[i]
                       << std::endl;
         std::cout << "===================================================================\n";
     }
+    //! function to simulate all packets and save the results
     void run()
     {
-        int curPacketIndex = 0;// index of current packet
-        Packet *pCurPacket = NULL;// pointer to current packet
-        long int nextWakeupRTime;// recorder of next wakeup time
-
-        //! repeat until there are not packets
-        while (curPacketIndex < mPackets.size())
+        simulate();
+        save2JSON();
+    }
+    //! function to simulate all packets on threadNum threads and save the results
+    void runParallel(int threadNum = 0)
+    {
+        simulateParallel(threadNum);
+        save2JSON();
+    }
+    //! function to feed all packets to the GPS simulator and depart them all
+    void simulate()
+    {
+        if (EqGPSsimulator)
+            simulate(EqGPSsimulator);
+        else
+            simulate(GPSsimulator);
+    }
+    //! function to feed all packets to the given GPS simulator
+    template <class Simulator>
+    void simulate(Simulator *GPSsimulator)
+    {
+        simulate(GPSsimulator,0,mPackets.Size());
+    }
+    //! function to feed packets [begin,end) to the given GPS simulator
+    /*! Returns whether the simulator is idle when packet end arrives, i.e.,
+        whether the packets from end on do not depend on the ones before.
+        After the last packet, the simulator is drained: every packet still
+        backlogged departs, so that all departure times are known.
+    */
+    template <class Simulator>
+    bool simulate(Simulator *GPSsimulator,size_t begin,size_t end)
+    {
+        //! handle the packets, with the departures due before each of them
+        if (end > begin)
+            GPSsimulator->HandleNewPacketArrivals(begin,end);
+        if (end == mPackets.Size())
+        {
+            GPSsimulator->Drain();
+            return true;
+        }
+        GPSsimulator->AdvanceTo(mPackets.mArrivalTime[end]);
+        return GPSsimulator->IsIdle();
+    }
+    //! function to feed all packets to GPS simulators on threadNum threads (all cores if 0)
+    void simulateParallel(int threadNum = 0)
+    {
+        if (threadNum <= 0)
+            threadNum = std::max(1u,std::thread::hardware_concurrency());
+        if (threadNum == 1)
+            simulate();
+        else if (EqGPSsimulator)
+            simulateParallel<GPSSim<0,EqualWeights> >(threadNum);
+        else
+            simulateParallel<GPSSim<> >(threadNum);
+    }
+    //! function to feed all packets to simulators of type Simulator on threadNum (> 0) threads
+    /*!
+        The GPS state is reset whenever the link goes idle, so the busy periods
+        are independent: the trace is split between them (see FindSegments())
+        and the segments are simulated by a pool of threads, each on its own
+        simulator. Packets are written in place, so the results are in order
+        as soon as the threads are done. A segment whose predecessor turns out
+        not to have drained before it started is simulated again in order,
+        continuing its predecessor, so the results are those of simulate().
+    */
+    template <class Simulator>
+    void simulateParallel(int threadNum)
+    {
+        std::vector<size_t> starts = FindSegments(std::max(MIN_SEGMENT_PACKETS,mPackets.Size() / (threadNum * SEGMENTS_PER_THREAD)));
+        int segmentNum = starts.size() - 1;
+        std::vector<char> drained(segmentNum);
+        std::vector<std::exception_ptr> errors(threadNum);
+        std::atomic<int> nextSegment(0);
+        auto worker = [&](int t)
         {
-            //! get next wakeup time
-            nextWakeupRTime = GPSsimulator->GetNextWakeupRTime();
-            //! get current packet pointer
-            pCurPacket = mPackets[curPacketIndex];
-            //! handle packets which should depart before current packet arrives
-            while ( nextWakeupRTime > 0 && nextWakeupRTime <= pCurPacket->mArrivalTime)
+            try{
+                std::unique_ptr<Simulator> GPSsimulator;
+                for (int s = nextSegment ++;s < segmentNum;s = nextSegment ++)
+                {
+                    //! an idle simulator is as good as new
+                    if (!GPSsimulator || !GPSsimulator->IsIdle())
+                        GPSsimulator.reset(new Simulator(&mPackets,mFlowWeights,mLinkRate));
+                    drained[s] = simulate(GPSsimulator.get(),starts[s],starts[s + 1]);
+                }
+            }
+            catch (...)
             {
-                GPSsimulator->WakeupProcessing(nextWakeupRTime);
-                nextWakeupRTime = GPSsimulator->GetNextWakeupRTime();
+                errors[t] = std::current_exception();
             }
-            //! handle this packet
-            GPSsimulator->HandleNewPacketArrival(pCurPacket);
-            ++ curPacketIndex;
+        };
+        std::vector<std::thread> threads;
+        for (int t = 1;t < threadNum;++ t)
+            threads.push_back(std::thread(worker,t));
+        worker(0);
+        for (auto& thread: threads)
+            thread.join();
+        for (auto& error: errors)
+            if (error) std::rethrow_exception(error);
+
+        for (int s = 0;s < segmentNum;++ s)
+        {
+            if (drained[s]) continue;
+            Simulator GPSsimulator(&mPackets,mFlowWeights,mLinkRate);
+            while (!simulate(&GPSsimulator,starts[s],starts[s + 1]))
+                ++ s;
         }
-        save2JSON();
+    }
+    //! function to get the virtual finish times of the packets, in arrival order
+    std::vector<VTime> GetFinishTimes()
+    {
+        return std::vector<VTime>(mPackets.mGPS_VFTime.begin(),mPackets.mGPS_VFTime.end());
     }
     void save2JSON()
     {
         json jDesp;
         json jFlow(mFlowWeights);
         jDesp["flow_weights"].push_back(jFlow);
-        for (int i = 0;i < mPackets.size();++ i)
+        jDesp["link_rate"] = mLinkRate;
+        for (int i = 0;i < mPackets.Size();++ i)
         {
             json jPacket = Packet2JSON(i);
             jDesp["packets"].push_back({jPacket});
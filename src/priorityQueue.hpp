@@ -2,22 +2,77 @@
 #define PRIORITYQUEUE_HPP
 
 #include "minHeap.hpp"
+#include "indexedMinHeap.hpp"
 
-template <class TYPE,class Compare = std::greater<TYPE> >
-class PriorityQueue: public MinHeap<TYPE,Compare> {
+template <class TYPE,class Compare = std::greater<TYPE>,int Arity = 2,class Alloc = std::allocator<TYPE> >
+class PriorityQueue: public MinHeap<TYPE,Compare,Arity,Alloc> {
 public:
-	using MinHeap<TYPE,Compare>::MinHeap;
+	using MinHeap<TYPE,Compare,Arity,Alloc>::MinHeap;
 	void Enqueue(TYPE t)
 	{
-		MinHeap<TYPE,Compare>::Insert(t);
+		MinHeap<TYPE,Compare,Arity,Alloc>::Insert(t);
 	}
 	TYPE PeekMin()
 	{
-		return MinHeap<TYPE,Compare>::Min();
+		return MinHeap<TYPE,Compare,Arity,Alloc>::Min();
 	}
 	void PopMin()
 	{
-		MinHeap<TYPE,Compare>::ExtractMin();
+		MinHeap<TYPE,Compare,Arity,Alloc>::ExtractMin();
+	}
+	//! pop the minimum while pred(minimum) holds, return the # of popped elements
+	template <class Predicate>
+	int PopMinWhile(Predicate pred)
+	{
+		int n = 0;
+		while (!MinHeap<TYPE,Compare,Arity,Alloc>::Empty() && pred(PeekMin()))
+		{
+			PopMin();
+			++ n;
+		}
+		return n;
+	}
+	//! pop every element ordered before bound, return the # of popped elements
+	int DrainUntil(const TYPE& bound)
+	{
+		Compare greater;
+		return PopMinWhile([&](const TYPE& t) { return greater(bound,t); });
+	}
+};
+
+template <class TYPE,class Compare = std::greater<TYPE>,int Arity = 2>
+class IndexedPriorityQueue: public IndexedMinHeap<TYPE,Compare,Arity> {
+public:
+	using IndexedMinHeap<TYPE,Compare,Arity>::IndexedMinHeap;
+	void Enqueue(int handle,TYPE t)
+	{
+		IndexedMinHeap<TYPE,Compare,Arity>::Insert(handle,t);
+	}
+	TYPE PeekMin()
+	{
+		return IndexedMinHeap<TYPE,Compare,Arity>::Min();
+	}
+	void PopMin()
+	{
+		IndexedMinHeap<TYPE,Compare,Arity>::ExtractMin();
+	}
+	//! pop the minimum while pred(minimum) holds, return the # of popped elements
+	template <class Predicate>
+	int PopMinWhile(Predicate pred)
+	{
+		int n = 0;
+		while (!IndexedMinHeap<TYPE,Compare,Arity>::Empty() && pred(PeekMin()))
+		{
+			PopMin();
+			++ n;
+		}
+		return n;
+	}
+	//! pop every element ordered before bound, return the # of popped elements
+	int DrainUntil(const TYPE& bound)
+	{
+		Compare greater;
+		return PopMinWhile([&](const TYPE& t) { return greater(bound,t); });
 	}
 };
 
@@ -0,0 +1,304 @@
+/*
+	C++ Implementation for Radix Heap
+	version 1.0.0
+
+*/
+
+#ifndef RADIX_HEAP_HPP
+#define RADIX_HEAP_HPP
+
+#include <iostream>
+#include <vector>
+#include <functional> // greater
+#include <algorithm> // sort
+#include <stdint.h> // uint64_t
+#include <stdexcept> // underflow out_of_range
+#include "keyBits.hpp"
+
+//! # of buckets of a radix heap on 64-bit keys
+const int RADIX_BUCKET_NUM = 65;
+
+//! The radix heap class
+/*!
+	Monotone priority queue (Ahuja, Mehlhorn, Orlin and Tarjan, 1990): the keys
+	inserted must never be smaller than the last extracted minimum (mLast).
+	Bucket 0 holds the elements whose key equals mLast, and bucket i > 0 those
+	whose key first differs from mLast at bit i - 1. Extracting from an empty
+	bucket 0 finds the smallest key in the first non-empty bucket and
+	redistributes that bucket into lower ones, so every element moves at most
+	64 times and no comparisons between elements are needed except to order
+	ties in bucket 0 by Compare (which, if total, yields the same departure
+	order as MinHeap).
+	Keys are given by KeyOf as non-negative doubles or integers, see KeyBits().
+	Elements are addressed by integer handles like IndexedMinHeap, so this
+	class is a drop-in replacement of IndexedPriorityQueue for monotone use.
+*/
+template <class TYPE,class KeyOf,class Compare=std::greater<TYPE> >
+class RadixHeap{
+	//! bucket entry: element, its key bits and its handle
+	struct Entry{
+		TYPE mValue;
+		uint64_t mKey;
+		int mHandle;
+	};
+	//! position of a handle: bucket and index in the bucket, bucket -1 if the handle has no element
+	struct Position{
+		int mBucket;
+		int mIndex;
+	};
+	//! buckets; bucket 0 is sorted in decreasing order (minimum at the back)
+	std::vector<Entry> mBuckets[RADIX_BUCKET_NUM];
+	//! position of each handle
+	std::vector<Position> mPos;
+	//! last extracted minimum key
+	uint64_t mLast;
+	//! handle of the minimum element, -1 if unknown
+	int mMinHandle;
+	//! # of elements
+	int mSize;
+	//! key function
+	KeyOf mKeyOf;
+	//! comparison function
+	Compare mGreater;
+	//! A function to compare two entries, true if e1 comes after e2
+	inline bool Greater(const Entry& e1,const Entry& e2)
+	{
+		if (e1.mKey != e2.mKey) return e1.mKey > e2.mKey;
+		return mGreater(e1.mValue,e2.mValue);
+	}
+	//! A function to get the entry of a handle which owns an element
+	inline Entry& EntryOf(int handle)
+	{
+		return mBuckets[mPos[handle].mBucket][mPos[handle].mIndex];
+	}
+	//! A function to get the bucket of a key relative to mLast
+	inline int BucketOf(uint64_t key)
+	{
+		return (key == mLast) ? 0 : 64 - __builtin_clzll(key ^ mLast);
+	}
+	//! A function to append an entry to a bucket > 0
+	inline void Append(int b,const Entry& e)
+	{
+		mPos[e.mHandle] = Position{b,(int) mBuckets[b].size()};
+		mBuckets[b].push_back(e);
+	}
+	//! A function to insert an entry to bucket 0, keeping it sorted by Compare
+	void InsertTie(const Entry& e)
+	{
+		std::vector<Entry>& bucket = mBuckets[0];
+		int i = bucket.size();
+		bucket.push_back(e);
+		while (i > 0 && mGreater(e.mValue,bucket[i - 1].mValue))
+		{
+			bucket[i] = bucket[i - 1];
+			mPos[bucket[i].mHandle].mIndex = i;
+			-- i;
+		}
+		bucket[i] = e;
+		mPos[e.mHandle] = Position{0,i};
+	}
+	//! A function to put an entry into its bucket
+	void Place(const Entry& e)
+	{
+		if (e.mKey < mLast)
+			throw new std::out_of_range("Radix heap key is smaller than the last extracted minimum.");
+		int b = BucketOf(e.mKey);
+		if (b == 0)
+			InsertTie(e);
+		else
+			Append(b,e);
+		if (mMinHandle >= 0 && Greater(EntryOf(mMinHandle),e)) mMinHandle = e.mHandle;
+	}
+	//! A function to find the handle of the minimum element, without moving any element
+	/*! mLast is not advanced here, since keys between mLast and the minimum may still be inserted.
+	*/
+	int FindMin()
+	{
+		if (mMinHandle >= 0) return mMinHandle;
+		if (!mBuckets[0].empty())
+			return mMinHandle = mBuckets[0].back().mHandle;
+		int b = 1;
+		while (mBuckets[b].empty()) ++ b;
+		const Entry *pMin = &mBuckets[b][0];
+		for (auto& e: mBuckets[b])
+			if (Greater(*pMin,e)) pMin = &e;
+		return mMinHandle = pMin->mHandle;
+	}
+	//! A function to advance mLast to the minimum key and move the minimum element to the back of bucket 0
+	void AdvanceToMin()
+	{
+		int b = mPos[FindMin()].mBucket;
+		if (b == 0) return;
+		std::vector<Entry> moving;
+		moving.swap(mBuckets[b]);
+		mLast = MinKeyOf(moving);
+		//! every entry of bucket b moves to a lower bucket
+		std::vector<Entry>& ties = mBuckets[0];
+		for (auto& e: moving)
+		{
+			if (e.mKey == mLast)
+				ties.push_back(e);
+			else
+				Append(BucketOf(e.mKey),e);
+		}
+		Compare greater = mGreater;
+		std::sort(ties.begin(),ties.end(),[&greater](const Entry& e1,const Entry& e2) { return greater(e1.mValue,e2.mValue); });
+		for (int i = 0;i < (int) ties.size();++ i)
+			mPos[ties[i].mHandle] = Position{0,i};
+		//! keep the storage of bucket b for later use
+		moving.clear();
+		moving.swap(mBuckets[b]);
+	}
+	//! A function to get the key of the minimum element among the entries moved out of its bucket
+	uint64_t MinKeyOf(const std::vector<Entry>& moving)
+	{
+		for (auto& e: moving)
+			if (e.mHandle == mMinHandle) return e.mKey;
+		throw new std::logic_error("RadixHeap lost its minimum element.");
+	}
+	//! A function to remove the entry of a handle, and return it
+	Entry Remove(int handle)
+	{
+		if (!Contains(handle))
+			throw new std::out_of_range("RadixHeap has no element with this handle.");
+		Position p = mPos[handle];
+		std::vector<Entry>& bucket = mBuckets[p.mBucket];
+		Entry e = bucket[p.mIndex];
+		if (handle == mMinHandle) mMinHandle = -1;
+		if (p.mBucket == 0)
+		{
+			//! keep bucket 0 sorted
+			for (int i = p.mIndex;i + 1 < (int) bucket.size();++ i)
+			{
+				bucket[i] = bucket[i + 1];
+				mPos[bucket[i].mHandle].mIndex = i;
+			}
+		}
+		else if (p.mIndex + 1 < (int) bucket.size())
+		{
+			bucket[p.mIndex] = bucket.back();
+			mPos[bucket[p.mIndex].mHandle].mIndex = p.mIndex;
+		}
+		bucket.pop_back();
+		mPos[handle].mBucket = -1;
+		-- mSize;
+		return e;
+	}
+	//! A function to insert an entry under its handle
+	void Add(const Entry& e)
+	{
+		if (e.mHandle < 0)
+			throw new std::out_of_range("RadixHeap handle must be non-negative.");
+		if (e.mHandle >= (int) mPos.size()) mPos.resize(e.mHandle + 1,Position{-1,0});
+		if (mPos[e.mHandle].mBucket >= 0)
+			throw new std::runtime_error("RadixHeap handle already owns an element.");
+		Place(e);
+		++ mSize;
+	}
+public:
+	//! A constructor with the expected number of handles specified
+	explicit RadixHeap(int handleNum = 0,KeyOf uKeyOf = KeyOf(),Compare uGreater = Compare())// constructor
+	{
+		mPos.assign(handleNum,Position{-1,0});
+		mLast = 0;
+		mMinHandle = -1;
+		mSize = 0;
+		mKeyOf = uKeyOf;
+		mGreater = uGreater;
+	}
+	//! A function to check whether a handle currently owns an element
+	bool Contains(int handle)
+	{
+		return handle >= 0 && handle < (int) mPos.size() && mPos[handle].mBucket >= 0;
+	}
+	//! A function to insert an element under a handle which currently owns no element
+	void Enqueue(int handle,TYPE x)
+	{
+		Add(Entry{x,KeyBits(mKeyOf(x)),handle});
+	}
+	//! A function to replace the element of a handle by x (whose key is not below the last extracted minimum)
+	void Replace(int handle,TYPE x)
+	{
+		Remove(handle);
+		Add(Entry{x,KeyBits(mKeyOf(x)),handle});
+	}
+	//! A function to restore the order after the key of a handle's element changed in place
+	void Update(int handle)
+	{
+		Entry e = Remove(handle);
+		e.mKey = KeyBits(mKeyOf(e.mValue));
+		Add(e);
+	}
+	//! A function to remove the element of a handle
+	void Erase(int handle)
+	{
+		Remove(handle);
+	}
+	//! A function to answer the query of the minimum element
+	TYPE PeekMin()
+	{
+		if (Empty())
+			throw new std::underflow_error("RadixHeap underflow.");
+		return EntryOf(FindMin()).mValue;
+	}
+	//! A function to get the handle of the minimum element
+	int MinHandle()
+	{
+		if (Empty())
+			throw new std::underflow_error("RadixHeap underflow.");
+		return FindMin();
+	}
+	//! A function to remove the minimum element
+	void PopMin()
+	{
+		int handle = MinHandle();
+		AdvanceToMin();
+		Remove(handle);
+	}
+	//! A function to replace the minimum element by x (owned by the same handle)
+	void ReplaceMin(TYPE x)
+	{
+		int handle = MinHandle();
+		AdvanceToMin();
+		Remove(handle);
+		Add(Entry{x,KeyBits(mKeyOf(x)),handle});
+	}
+	//! A function to remove all elements and restart from key 0, e.g., at the end of a busy period
+	/*! O(1) when the heap is already empty.
+	*/
+	void Clear()
+	{
+		if (mSize > 0)
+			for (auto& bucket: mBuckets)
+			{
+				for (auto& e: bucket)
+					mPos[e.mHandle].mBucket = -1;
+				bucket.clear();
+			}
+		mSize = 0;
+		mLast = 0;
+		mMinHandle = -1;
+	}
+	//! A function to track whether the heap is empty
+	bool Empty()
+	{
+		return (mSize == 0);
+	}
+	//! A function to get the current size of the heap
+	int Size()
+	{
+		return mSize;
+	}
+	//! A function to print out the elements (with their handles), bucket by bucket
+	void Print()
+	{
+		for (auto& bucket: mBuckets)
+			for (auto& e: bucket)
+				std::cout << e.mHandle << ":" << e.mValue << " ";
+		std::cout << std::endl;
+	}
+};
+
+
+
+#endif
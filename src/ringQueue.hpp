@@ -0,0 +1,116 @@
+/*
+	C++ Implementation for Ring Buffer FIFO Queue
+	version 1.0.0
+
+*/
+
+#ifndef RING_QUEUE_HPP
+#define RING_QUEUE_HPP
+
+#include <iostream>
+#include <vector>
+#include <stddef.h> // size_t
+#include <stdexcept> // underflow out_of_range
+
+//! initial # of slots of a RingQueue, allocated by its first Push()
+const size_t RING_QUEUE_MIN_CAPACITY = 8;
+
+//! The ring buffer queue class
+/*!
+	A FIFO queue on a power-of-two ring buffer: Push and Pop move a head or a
+	tail index masked by the capacity, and the elements stay contiguous in one
+	buffer rather than in the chunks of a std::deque. The buffer doubles when
+	full and never shrinks (Clear() keeps it), so once a queue has reached its
+	largest length it never allocates again.
+*/
+template <class TYPE>
+class RingQueue{
+	//! storage of the elements, its size being 0 or a power of two
+	std::vector<TYPE> mRing;
+	//! size of mRing - 1, masking slot numbers
+	size_t mMask;
+	//! slot of the first element
+	size_t mHead;
+	//! # of elements
+	size_t mSize;
+	//! A function to double the capacity, moving the elements to the front of the new buffer
+	void Grow()
+	{
+		std::vector<TYPE> ring(mRing.empty() ? RING_QUEUE_MIN_CAPACITY : 2 * mRing.size());
+		for (size_t i = 0;i < mSize;++ i)
+			ring[i] = mRing[(mHead + i) & mMask];
+		mRing.swap(ring);
+		mMask = mRing.size() - 1;
+		mHead = 0;
+	}
+public:
+	//! A constructor
+	RingQueue()
+	{
+		mMask = 0;
+		mHead = 0;
+		mSize = 0;
+	}
+	//! A function to append an element at the tail
+	inline void Push(const TYPE& x)
+	{
+		if (mSize == mRing.size())
+			Grow();
+		mRing[(mHead + mSize) & mMask] = x;
+		++ mSize;
+	}
+	//! A function to remove the element at the head
+	inline void Pop()
+	{
+		if (mSize == 0)
+			throw new std::underflow_error("RingQueue underflow.");
+		mHead = (mHead + 1) & mMask;
+		-- mSize;
+	}
+	//! A function to get the element at the head
+	inline TYPE& Front()
+	{
+		if (mSize == 0)
+			throw new std::underflow_error("RingQueue underflow.");
+		return mRing[mHead];
+	}
+	//! A function to get the i-th element from the head
+	inline TYPE& At(size_t i)
+	{
+		if (i >= mSize)
+			throw new std::out_of_range("RingQueue has no element at this position.");
+		return mRing[(mHead + i) & mMask];
+	}
+	//! A function to remove all elements, keeping the buffer
+	void Clear()
+	{
+		mHead = 0;
+		mSize = 0;
+	}
+	//! A function to get the # of elements
+	inline size_t Size()
+	{
+		return mSize;
+	}
+	//! A function to check whether the queue is empty
+	inline bool Empty()
+	{
+		return mSize == 0;
+	}
+	//! A function to get the # of elements the buffer holds without growing
+	size_t Capacity()
+	{
+		return mRing.size();
+	}
+	//! A function to print the elements from head to tail
+	void Print()
+	{
+		for (size_t i = 0;i < mSize;++ i)
+			std::cout << At(i) << " ";
+		std::cout << std::endl;
+	}
+};
+
+
+
+#endif
@@ -0,0 +1,300 @@
+/*
+	C++ Implementation for Linear-Scan Minimum Selector
+	version 1.0.0
+
+*/
+
+#ifndef SCAN_SELECTOR_HPP
+#define SCAN_SELECTOR_HPP
+
+#include <iostream>
+#include <vector>
+#include <limits> // infinity max
+#include <utility> // declval
+#include <type_traits> // conditional is_integral decay
+#include <stdint.h> // uintptr_t
+#include <stdexcept> // underflow out_of_range
+#if defined(__AVX2__) || defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//! # of keys (doubles or 64-bit integers) in the widest vector register used by the scan
+const int SCAN_LANES = 4;
+
+//! The linear-scan selector class
+/*!
+	Keeps the key of every handle's element in a dense, 32-byte aligned array
+	(the largest key for handles without element) and finds the minimum by
+	scanning it with AVX (4 doubles per step), SSE2 (2 per step) or scalar
+	code, picked at compile time. Enqueue, Replace, Erase and PopMin are O(1) stores; the
+	minimum is rescanned in O(n / lanes) only after it was removed or raised.
+	Ties on the key are resolved to the smallest handle. For the small flow
+	counts of GPSSim (MAX_FLOW_NUM) the scan beats a heap's pointer chasing.
+	Offers the same interface as IndexedPriorityQueue.
+	If KeyOf returns an integer type (e.g., fixed-point virtual times), keys are
+	kept as long long, exact over the whole range, and scanned with AVX2 64-bit
+	compares (4 per step) or scalar code; otherwise keys are kept as doubles.
+	Elements with the largest key (+infinity or LLONG_MAX) are not supported.
+*/
+template <class TYPE,class KeyOf>
+class ScanSelector{
+	//! type of the keys: long long for integer keys, else double
+	typedef typename std::decay<decltype(std::declval<KeyOf&>()(std::declval<TYPE>()))>::type KeyOfResult;
+	typedef typename std::conditional<std::is_integral<KeyOfResult>::value,long long,double>::type Key;
+	//! key of the handles without element, larger than all keys of elements
+	static Key NoKey()
+	{
+		return std::numeric_limits<Key>::has_infinity ? std::numeric_limits<Key>::infinity() : std::numeric_limits<Key>::max();
+	}
+	//! storage of the keys (mpKeys points into it)
+	std::vector<Key> mKeyStorage;
+	//! keys, indexed by handle, padded to a multiple of SCAN_LANES with NoKey()
+	Key *mpKeys;
+	//! # of handles (without padding)
+	int mHandleNum;
+	//! element of each handle
+	std::vector<TYPE> mValues;
+	//! handle of the minimum element, -1 if unknown
+	int mMinHandle;
+	//! # of elements
+	int mSize;
+	//! key function
+	KeyOf mKeyOf;
+	//! A function to grow the key array to handleNum handles
+	void Grow(int handleNum)
+	{
+		int padded = (handleNum + SCAN_LANES - 1) / SCAN_LANES * SCAN_LANES;
+		std::vector<Key> storage(padded + SCAN_LANES,NoKey());
+		Key *pKeys = storage.data();
+		while (reinterpret_cast<uintptr_t>(pKeys) % (SCAN_LANES * sizeof(Key)) != 0) ++ pKeys;
+		for (int i = 0;i < mHandleNum;++ i)
+			pKeys[i] = mpKeys[i];
+		mKeyStorage.swap(storage);
+		mpKeys = pKeys;
+		mHandleNum = handleNum;
+		mValues.resize(handleNum);
+	}
+	//! A function to get the # of keys to scan (a multiple of SCAN_LANES)
+	inline int PaddedNum()
+	{
+		return (mHandleNum + SCAN_LANES - 1) / SCAN_LANES * SCAN_LANES;
+	}
+	//! A function to find the minimum of n double keys (n a multiple of SCAN_LANES)
+	static double ScanMinKey(const double *pKeys,int n)
+	{
+#if defined(__AVX__)
+		__m256d m = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+		for (int i = 0;i < n;i += 4)
+			m = _mm256_min_pd(m,_mm256_load_pd(pKeys + i));
+		__m128d h = _mm_min_pd(_mm256_castpd256_pd128(m),_mm256_extractf128_pd(m,1));
+		h = _mm_min_sd(h,_mm_unpackhi_pd(h,h));
+		return _mm_cvtsd_f64(h);
+#elif defined(__SSE2__)
+		__m128d m = _mm_set1_pd(std::numeric_limits<double>::infinity());
+		for (int i = 0;i < n;i += 2)
+			m = _mm_min_pd(m,_mm_load_pd(pKeys + i));
+		m = _mm_min_sd(m,_mm_unpackhi_pd(m,m));
+		return _mm_cvtsd_f64(m);
+#else
+		double m = std::numeric_limits<double>::infinity();
+		for (int i = 0;i < n;++ i)
+			m = (pKeys[i] < m) ? pKeys[i] : m;
+		return m;
+#endif
+	}
+	//! A function to find the first of n double keys which equals key
+	static int ScanFirst(const double *pKeys,int n,double key)
+	{
+#if defined(__AVX__)
+		__m256d k = _mm256_set1_pd(key);
+		for (int i = 0;i < n;i += 4)
+		{
+			int mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_load_pd(pKeys + i),k,_CMP_EQ_OQ));
+			if (mask) return i + __builtin_ctz(mask);
+		}
+#elif defined(__SSE2__)
+		__m128d k = _mm_set1_pd(key);
+		for (int i = 0;i < n;i += 2)
+		{
+			int mask = _mm_movemask_pd(_mm_cmpeq_pd(_mm_load_pd(pKeys + i),k));
+			if (mask) return i + __builtin_ctz(mask);
+		}
+#else
+		for (int i = 0;i < n;++ i)
+			if (pKeys[i] == key) return i;
+#endif
+		return -1;
+	}
+	//! A function to find the minimum of n integer keys (n a multiple of SCAN_LANES)
+	static long long ScanMinKey(const long long *pKeys,int n)
+	{
+#if defined(__AVX2__)
+		__m256i m = _mm256_set1_epi64x(std::numeric_limits<long long>::max());
+		for (int i = 0;i < n;i += 4)
+		{
+			__m256i k = _mm256_load_si256((const __m256i *) (pKeys + i));
+			m = _mm256_blendv_epi8(m,k,_mm256_cmpgt_epi64(m,k));
+		}
+		alignas(32) long long lanes[4];
+		_mm256_store_si256((__m256i *) lanes,m);
+		long long l = (lanes[0] < lanes[1]) ? lanes[0] : lanes[1];
+		long long h = (lanes[2] < lanes[3]) ? lanes[2] : lanes[3];
+		return (l < h) ? l : h;
+#else
+		long long m = std::numeric_limits<long long>::max();
+		for (int i = 0;i < n;++ i)
+			m = (pKeys[i] < m) ? pKeys[i] : m;
+		return m;
+#endif
+	}
+	//! A function to find the first of n integer keys which equals key
+	static int ScanFirst(const long long *pKeys,int n,long long key)
+	{
+#if defined(__AVX2__)
+		__m256i k = _mm256_set1_epi64x(key);
+		for (int i = 0;i < n;i += 4)
+		{
+			int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_load_si256((const __m256i *) (pKeys + i)),k)));
+			if (mask) return i + __builtin_ctz(mask);
+		}
+#else
+		for (int i = 0;i < n;++ i)
+			if (pKeys[i] == key) return i;
+#endif
+		return -1;
+	}
+	//! A function to check whether handle h1's element comes before handle h2's
+	inline bool Less(int h1,int h2)
+	{
+		return mpKeys[h1] < mpKeys[h2] || (mpKeys[h1] == mpKeys[h2] && h1 < h2);
+	}
+	//! A function to check that a handle owns an element
+	void CheckHandle(int handle)
+	{
+		if (!Contains(handle))
+			throw new std::out_of_range("ScanSelector has no element with this handle.");
+	}
+	//! A function to store the key of a handle, keeping the cached minimum valid when possible
+	void SetKey(int handle,Key key)
+	{
+		bool raised = (handle == mMinHandle && key > mpKeys[handle]);
+		mpKeys[handle] = key;
+		if (raised)
+			mMinHandle = -1;
+		else if (mMinHandle >= 0 && Less(handle,mMinHandle))
+			mMinHandle = handle;
+	}
+public:
+	//! copying would leave mpKeys pointing into the source's storage
+	ScanSelector(const ScanSelector&) = delete;
+	ScanSelector& operator=(const ScanSelector&) = delete;
+	//! A constructor with the expected number of handles specified
+	explicit ScanSelector(int handleNum = 0,KeyOf uKeyOf = KeyOf())// constructor
+	{
+		mpKeys = NULL;
+		mHandleNum = 0;
+		Grow(handleNum);
+		mMinHandle = -1;
+		mSize = 0;
+		mKeyOf = uKeyOf;
+	}
+	//! A function to check whether a handle currently owns an element
+	bool Contains(int handle)
+	{
+		return handle >= 0 && handle < mHandleNum && mpKeys[handle] != NoKey();
+	}
+	//! A function to insert an element under a handle which currently owns no element
+	void Enqueue(int handle,TYPE x)
+	{
+		if (handle < 0)
+			throw new std::out_of_range("ScanSelector handle must be non-negative.");
+		if (handle >= mHandleNum) Grow(handle + 1);
+		if (Contains(handle))
+			throw new std::runtime_error("ScanSelector handle already owns an element.");
+		mValues[handle] = x;
+		bool wasEmpty = Empty();
+		mpKeys[handle] = mKeyOf(x);
+		++ mSize;
+		if (wasEmpty)
+			mMinHandle = handle;
+		else if (mMinHandle >= 0 && Less(handle,mMinHandle))
+			mMinHandle = handle;
+	}
+	//! A function to replace the element of a handle by x
+	void Replace(int handle,TYPE x)
+	{
+		CheckHandle(handle);
+		mValues[handle] = x;
+		SetKey(handle,mKeyOf(x));
+	}
+	//! A function to refresh the key of a handle's element after it changed in place
+	void Update(int handle)
+	{
+		CheckHandle(handle);
+		SetKey(handle,mKeyOf(mValues[handle]));
+	}
+	//! A function to remove the element of a handle
+	void Erase(int handle)
+	{
+		CheckHandle(handle);
+		mpKeys[handle] = NoKey();
+		-- mSize;
+		if (handle == mMinHandle) mMinHandle = -1;
+	}
+	//! A function to get the handle of the minimum element
+	int MinHandle()
+	{
+		if (Empty())
+			throw new std::underflow_error("ScanSelector underflow.");
+		if (mMinHandle < 0) mMinHandle = ScanFirst(mpKeys,PaddedNum(),ScanMinKey(mpKeys,PaddedNum()));
+		return mMinHandle;
+	}
+	//! A function to answer the query of the minimum element
+	TYPE PeekMin()
+	{
+		return mValues[MinHandle()];
+	}
+	//! A function to remove the minimum element
+	void PopMin()
+	{
+		Erase(MinHandle());
+	}
+	//! A function to replace the minimum element by x (owned by the same handle)
+	void ReplaceMin(TYPE x)
+	{
+		Replace(MinHandle(),x);
+	}
+	//! A function to remove all elements, O(1) when the selector is already empty
+	void Clear()
+	{
+		if (mSize == 0) return;
+		for (int i = 0;i < mHandleNum;++ i)
+			mpKeys[i] = NoKey();
+		mSize = 0;
+		mMinHandle = -1;
+	}
+	//! A function to track whether the selector is empty
+	bool Empty()
+	{
+		return (mSize == 0);
+	}
+	//! A function to get the current # of elements
+	int Size()
+	{
+		return mSize;
+	}
+	//! A function to print out the elements (with their handles) in handle order
+	void Print()
+	{
+		for (int i = 0;i < mHandleNum;++ i)
+			if (Contains(i))
+				std::cout << i << ":" << mValues[i] << " ";
+		std::cout << std::endl;
+	}
+};
+
+
+
+#endif
@@ -0,0 +1,29 @@
+#include <vector>
+#include "calendarQueue.hpp"
+
+//! key of an int element is the element itself
+struct IntKey {
+	double operator()(int x) { return x; }
+};
+
+int main()
+{
+
+	std::vector<int> myData = {8,71,41,31,10,11,16,46,51,31,21,13};
+
+	CalendarQueue<int,IntKey> cq;
+
+	// handle i owns myData[i]
+	for (int i = 0;i < (int) myData.size();++ i)
+		cq.Enqueue(i,myData[i]);
+
+	cq.Enqueue(12,55);
+
+	cq.Print();
+
+	while (!cq.Empty())
+	{
+		std::cout << cq.MinHandle() << ":" << cq.PeekMin() << std::endl;
+		cq.PopMin();
+	}
+}
@@ -0,0 +1,28 @@
+#include <vector>
+#include "flowTable.hpp"
+
+int main()
+{
+
+	// 5-tuple hashes, small ids and the extreme ids, with repeats
+	std::vector<FlowId> myData = {0x9f3a61c2d4e5b701ULL,3,0,0xffffffffffffffffULL,3,17,0x9f3a61c2d4e5b701ULL,1,2,17};
+
+	FlowTable ft;
+
+	// flows get indices in order of first sight
+	for (size_t i = 0;i < myData.size();++ i)
+		std::cout << ft.IndexOf(myData[i]) << " ";
+	std::cout << std::endl;
+
+	ft.Print();
+
+	std::cout << "find 17: " << ft.Find(17) << ", find 4: " << ft.Find(4) << std::endl;
+
+	// grow through several rehashes, then check every mapping
+	for (FlowId id = 1000;id < 101000;++ id)
+		ft.IndexOf(id * 0x100000001ULL);
+	bool ok = true;
+	for (int i = 0;i < ft.Size();++ i)
+		ok = ok && ft.Find(ft.IdOf(i)) == i;
+	std::cout << "flows " << ft.Size() << (ok ? ", all found" : ", lookup failed") << std::endl;
+}
@@ -0,0 +1,364 @@
+/*
+	Scenarios of the GPS simulator with hand-computed finish and departure times
+
+	Every link serves one byte per nanosecond (DEFAULT_LINK_RATE), so a flow
+	of weight w among backlogged flows of total weight W is served w / W
+	bytes per nanosecond, and virtual time grows by 1 / W per nanosecond.
+	Prints every result next to its expected value, and exits with the #
+	of mismatches; build with and without GPS_FIXED_POINT_VTIME.
+*/
+#include <iostream>
+#include <math.h> // fabs
+#include <stdexcept> // overflow_error out_of_range invalid_argument
+#include "GPSsim.hpp"
+
+//! # of results which differ from their expected value
+int failures = 0;
+
+//! A function to print a result next to its expected value, which it may differ from by tolerance
+void Check(const char *what,double value,double expected,double tolerance = 0)
+{
+	bool ok = fabs(value - expected) <= tolerance;
+	std::cout << "  " << what << ": " << value << " (expected " << expected << ")"
+	          << (ok ? "" : "  <-- MISMATCH") << std::endl;
+	if (!ok) ++ failures;
+}
+
+//! A function to print the finish time and departure time of packet i
+void CheckPacket(const PacketTable& packets,PacketIndex i,double vfTime,RTime departureTime)
+{
+	std::cout << " packet " << i << " of flow " << packets.FlowIdOf(i) << std::endl;
+	Check("finish time",VTimeOps<VTime>::ToDouble(packets.mGPS_VFTime[i]),vfTime);
+	Check("departure time",(double) packets.mGPS_DepartureTime[i],(double) departureTime);
+}
+
+//! three flows of weight 1 start at 0 with 100, 200 and 3000 bytes; flow 3 is torn down at 2000
+/*!
+	Among 3 flows, virtual time grows by 1/3 per ns: flow 1 departs at
+	virtual time 100, i.e., 300 ns. Among 2 flows, flow 2 departs at
+	virtual time 200, i.e., 300 + 2 * 100 = 500 ns. Both departures are due
+	before the tear down, which must process them first.
+*/
+void TestTearDownWithPendingDepartures()
+{
+	std::cout << "tear down with departures pending" << std::endl;
+	PacketTable packets;
+	packets.Append(Packet(1,0,100,0));
+	packets.Append(Packet(2,0,200,0));
+	packets.Append(Packet(3,0,3000,0));
+	GPSSim<> sim(&packets,std::vector<double>{1,1,1});
+	sim.HandleNewPacketArrivals(0,3);
+	sim.TearDownFlow(3,2000);
+	sim.Drain();
+	CheckPacket(packets,0,100,300);
+	CheckPacket(packets,1,200,500);
+	CheckPacket(packets,2,3000,-1);
+}
+
+//! the same flows, with the weight of flow 3 set to 2 at 2000 instead
+/*!
+	Flows 1 and 2 depart at 300 and 500 ns as above, at virtual time 200.
+	Alone, flow 3 is served at 1 byte per ns: at 2000 ns virtual time is
+	200 + 1500 = 1700, so 1300 bytes remain, which take 650 virtual time
+	units at weight 2: the finish time becomes 2350 and flow 3 departs at
+	2000 + 1300 = 3300 ns.
+*/
+void TestReweightWithPendingDepartures()
+{
+	std::cout << "reweight with departures pending" << std::endl;
+	PacketTable packets;
+	packets.Append(Packet(1,0,100,0));
+	packets.Append(Packet(2,0,200,0));
+	packets.Append(Packet(3,0,3000,0));
+	GPSSim<> sim(&packets,std::vector<double>{1,1,1});
+	sim.HandleNewPacketArrivals(0,3);
+	sim.SetFlowWeight(3,2,2000);
+	sim.Drain();
+	CheckPacket(packets,0,100,300);
+	CheckPacket(packets,1,200,500);
+	CheckPacket(packets,2,2350,3300);
+}
+
+//! flows 1 and 2 of weight 1 start at 0 with 100 and 1000 bytes; flow 1 sends 100 more bytes at 300
+/*!
+	Flow 1 departs at virtual time 100, i.e., 200 ns. Virtual time then grows
+	by 1 per ns, from that departure: it is 200 at 300 ns, so the new packet
+	finishes at 300, reached 200 ns later among 2 flows, at 500 ns. Flow 2
+	finishes at 1000, 700 ns after 500 when it is alone, at 1200 ns.
+	(Measured from the arrival at 0 at the new total weight instead, virtual
+	time would be 300 at 300 ns and the new packet would finish at 400.)
+*/
+void TestDepartureIsAnEvent()
+{
+	std::cout << "departure as a virtual time event" << std::endl;
+	PacketTable packets;
+	packets.Append(Packet(1,0,100,0));
+	packets.Append(Packet(2,0,1000,0));
+	packets.Append(Packet(1,1,100,300));
+	GPSSim<> sim(&packets,std::vector<double>{1,1});
+	sim.HandleNewPacketArrivals(0,3);
+	sim.Drain();
+	CheckPacket(packets,0,100,200);
+	CheckPacket(packets,1,1000,1200);
+	CheckPacket(packets,2,300,500);
+}
+
+//! flows 1 and 2 of weight 1 send 100 bytes at 0 and 200; flow 1 is torn down, then reweighted, at 100
+/*!
+	The arrival at 200 is the last event: both calls go back in time and
+	must be rejected rather than run virtual time backwards. Flow 1 departs
+	at 100 ns, and flow 2, in a new busy period, at 300 ns.
+*/
+void TestCallBeforeLastEvent()
+{
+	std::cout << "flow changes before the last event" << std::endl;
+	PacketTable packets;
+	packets.Append(Packet(1,0,100,0));
+	packets.Append(Packet(2,0,100,200));
+	GPSSim<> sim(&packets,std::vector<double>{1,1});
+	sim.HandleNewPacketArrivals(0,2);
+	bool rejected = false;
+	try
+	{
+		sim.TearDownFlow(1,100);
+	}
+	catch (std::invalid_argument *e)
+	{
+		rejected = true;
+		delete e;
+	}
+	Check("tear down rejected",rejected,1);
+	rejected = false;
+	try
+	{
+		sim.SetFlowWeight(1,2,100);
+	}
+	catch (std::invalid_argument *e)
+	{
+		rejected = true;
+		delete e;
+	}
+	Check("reweight rejected",rejected,1);
+	sim.Drain();
+	CheckPacket(packets,0,100,100);
+	CheckPacket(packets,1,100,300);
+}
+
+//! three flows of weights 1, 2 and 1 start at 0 with 100, 400 and 300 bytes, in a GPSSim<3>
+/*!
+	The finish times are 100 / 1, 400 / 2 and 300 / 1. Among total weight 4,
+	virtual time grows by 1/4 per ns: flow 1 departs at 400 ns. Among weight
+	3, virtual time reaches 200 300 ns later: flow 2 departs at 700 ns. Flow 3
+	is then alone and departs 100 ns later, at 800 ns.
+*/
+void TestFixedFlowNum()
+{
+	std::cout << "flow number fixed at compile time" << std::endl;
+	PacketTable packets;
+	packets.Append(Packet(1,0,100,0));
+	packets.Append(Packet(2,0,400,0));
+	packets.Append(Packet(3,0,300,0));
+	GPSSim<3> sim(&packets,std::vector<double>{1,2,1});
+	sim.HandleNewPacketArrivals(0,3);
+	sim.Drain();
+	CheckPacket(packets,0,100,400);
+	CheckPacket(packets,1,200,700);
+	CheckPacket(packets,2,300,800);
+}
+
+//! flow 1 sends 100 bytes at 0, 10, 20 and 50 ns, flow 2 sends 300 bytes at 30 ns, at weight 1
+/*!
+	The packets of flow 1 at 10 and 20 ns arrive before its first departure,
+	so HandleNewPacketArrivals() appends them as a burst: they finish at 200
+	and 300, each 100 after the previous one. Alone until 30 ns, flow 1 has
+	virtual time 30 when flow 2 arrives, finishing at 330; virtual time then
+	grows by 1/2 per ns, and the packet of flow 1 at 50 ns finishes at 400.
+	Flow 1 departs at virtual times 100, 200 and 300, i.e., 30 + 2 * 70 = 170,
+	370 and 570 ns, flow 2 at 330, 60 ns later at 630 ns, and flow 1, alone
+	again, at 400, 70 ns later at 700 ns.
+*/
+void TestBurst()
+{
+	std::cout << "burst of a backlogged flow" << std::endl;
+	PacketTable packets;
+	packets.Append(Packet(1,0,100,0));
+	packets.Append(Packet(1,1,100,10));
+	packets.Append(Packet(1,2,100,20));
+	packets.Append(Packet(2,0,300,30));
+	packets.Append(Packet(1,3,100,50));
+	GPSSim<> sim(&packets,std::vector<double>{1,1});
+	sim.HandleNewPacketArrivals(0,5);
+	sim.Drain();
+	CheckPacket(packets,0,100,170);
+	CheckPacket(packets,1,200,370);
+	CheckPacket(packets,2,300,570);
+	CheckPacket(packets,3,330,630);
+	CheckPacket(packets,4,400,700);
+}
+
+//! flows 1 to 4 of weights 1, 1, 2 and 1 start at 0 with 100, 100, 200 and 300 bytes
+/*!
+	Flows 1 to 3 all finish at virtual time 100, reached after 5 * 100 ns:
+	they depart together at 500 ns, in one wakeup.
+	Flow 4, then alone, finishes at 300, 200 ns later, at 700 ns.
+*/
+void TestTiedDepartures()
+{
+	std::cout << "tied departures" << std::endl;
+	PacketTable packets;
+	packets.Append(Packet(1,0,100,0));
+	packets.Append(Packet(2,0,100,0));
+	packets.Append(Packet(3,0,200,0));
+	packets.Append(Packet(4,0,300,0));
+	GPSSim<> sim(&packets,std::vector<double>{1,1,2,1});
+	sim.HandleNewPacketArrivals(0,4);
+	Check("first departure time",(double) sim.GetNextWakeupRTime(),500);
+	Check("departures of its wakeup",(double) sim.WakeupProcessing(500),3);
+	Check("next departure time",(double) sim.GetNextWakeupRTime(),700);
+	sim.Drain();
+	CheckPacket(packets,0,100,500);
+	CheckPacket(packets,1,100,500);
+	CheckPacket(packets,2,100,500);
+	CheckPacket(packets,3,300,700);
+}
+
+//! flow 1 of weight 2 sends 300 bytes at 0 and 200 at 100, flow 2 of weight 1 sends 300 bytes at 0
+/*!
+	The packets at 0 finish at 300 / 2 = 150 and 300, the one at 100 at
+	150 + 200 / 2 = 250. Among weight 3, virtual time grows by 1/3 per ns:
+	flow 1 departs at 450 and 750 ns, then flow 2, alone for virtual time
+	300 - 250, at 800 ns. AdvanceTo(700) processes the first departure and
+	Drain() the two others, leaving the simulator idle.
+*/
+void TestDrain()
+{
+	std::cout << "drain" << std::endl;
+	PacketTable packets;
+	packets.Append(Packet(1,0,300,0));
+	packets.Append(Packet(2,0,300,0));
+	packets.Append(Packet(1,1,200,100));
+	GPSSim<> sim(&packets,std::vector<double>{2,1});
+	Check("departures until 100 ns",(double) sim.HandleNewPacketArrivals(0,3),0);
+	Check("departures until 700 ns",(double) sim.AdvanceTo(700),1);
+	Check("departures drained",(double) sim.Drain(),2);
+	Check("idle",sim.IsIdle(),1);
+	CheckPacket(packets,0,150,450);
+	CheckPacket(packets,1,300,800);
+	CheckPacket(packets,2,250,750);
+}
+
+//! flows 1 and 2 of weight 1 send 100 and 200 bytes at 0, then 100 and 50 bytes at 1000
+/*!
+	The first busy period ends at 300 ns with the departure of flow 2 (at
+	virtual time 200, after flow 1's at virtual time 100, 200 ns). The second
+	starts again from virtual time 0 at 1000 ns, where the flows' last finish
+	times from the first one must be forgotten: the new packets finish at 100
+	and 50, not 200 and 250. Flow 2 departs after 2 * 50 ns, at 1100 ns, and
+	flow 1, alone for the last 50 bytes, at 1150 ns.
+*/
+void TestNewBusyPeriod()
+{
+	std::cout << "flow state across busy periods" << std::endl;
+	PacketTable packets;
+	packets.Append(Packet(1,0,100,0));
+	packets.Append(Packet(2,0,200,0));
+	packets.Append(Packet(1,1,100,1000));
+	packets.Append(Packet(2,1,50,1000));
+	GPSSim<> sim(&packets,std::vector<double>{1,1});
+	sim.HandleNewPacketArrivals(0,4);
+	sim.Drain();
+	CheckPacket(packets,0,100,200);
+	CheckPacket(packets,1,200,300);
+	CheckPacket(packets,2,100,1150);
+	CheckPacket(packets,3,50,1100);
+}
+
+//! one flow of weight 0.01 sends 300000 packets of 1500 bytes, one every 1400 ns
+/*!
+	Packets arrive faster than the link serves them, so the busy period
+	lasts until the last packet departs, at 300000 * 1500 ns. Alone, the flow
+	finishes packet k at virtual time (k + 1) * 1500 / 0.01, reaching
+	4.5e10, beyond 2^35: fixed-point virtual times must not overflow. They
+	round the weight to 655 / 2^16, finishing 0.05% later in virtual time.
+*/
+void TestLongBusyPeriod()
+{
+	std::cout << "long busy period of a light flow" << std::endl;
+	const int packetNum = 300000;
+	PacketTable packets;
+	for (int k = 0;k < packetNum;++ k)
+		packets.Append(Packet(1,k,1500,(RTime) k * 1400));
+	GPSSim<> sim(&packets,std::vector<double>{0.01});
+	sim.HandleNewPacketArrivals(0,packetNum);
+	sim.Drain();
+	std::cout << " packet " << packetNum - 1 << " of flow 1" << std::endl;
+	Check("finish time",VTimeOps<VTime>::ToDouble(packets.mGPS_VFTime[packetNum - 1]),4.5e10,4.5e7);
+	Check("departure time",(double) packets.mGPS_DepartureTime[packetNum - 1],4.5e8);
+}
+
+//! one flow of weight 0.0001 sends 8000 packets of 65535 bytes at 0
+/*!
+	The last finish time is 8000 * 65535 / 0.0001, about 5.2e12 (2^42.3):
+	beyond MAX_FIXED_VTIME, so fixed-point virtual time reports it.
+*/
+void TestOverflowIsReported()
+{
+	std::cout << "virtual time overflow" << std::endl;
+	const int packetNum = 8000;
+	PacketTable packets;
+	for (int k = 0;k < packetNum;++ k)
+		packets.Append(Packet(1,k,65535,0));
+	GPSSim<> sim(&packets,std::vector<double>{0.0001});
+	bool reported = false;
+	try
+	{
+		sim.HandleNewPacketArrivals(0,packetNum);
+	}
+	catch (std::overflow_error *e)
+	{
+		reported = true;
+		delete e;
+	}
+#if defined(GPS_FIXED_POINT_VTIME)
+	Check("overflow reported",reported,1);
+#else
+	Check("overflow reported",reported,0);
+#endif
+}
+
+//! a packet longer than the 16-bit length column of the packet table
+void TestLongPacketIsRejected()
+{
+	std::cout << "packet length beyond 16 bits" << std::endl;
+	PacketTable packets;
+	bool rejected = false;
+	try
+	{
+		packets.Append(Packet(1,0,MAX_PACKET_LENGTH + 1,0));
+	}
+	catch (std::out_of_range *e)
+	{
+		rejected = true;
+		delete e;
+	}
+	Check("packet rejected",rejected,1);
+	Check("packets",(double) packets.Size(),0);
+}
+
+int main()
+{
+	TestTearDownWithPendingDepartures();
+	TestReweightWithPendingDepartures();
+	TestDepartureIsAnEvent();
+	TestCallBeforeLastEvent();
+	TestFixedFlowNum();
+	TestBurst();
+	TestTiedDepartures();
+	TestDrain();
+	TestNewBusyPeriod();
+	TestLongBusyPeriod();
+	TestOverflowIsReported();
+	TestLongPacketIsRejected();
+	std::cout << failures << " mismatches" << std::endl;
+	return failures;
+}
@@ -0,0 +1,31 @@
+#include <vector>
+#include "priorityQueue.hpp"
+
+int main()
+{
+
+	std::vector<int> myData = {8,71,41,31,10,11,16,46,51,31,21,13};
+
+	IndexedPriorityQueue<int> pq;
+
+	// handle i owns myData[i]
+	for (int i = 0;i < (int) myData.size();++ i)
+		pq.Enqueue(i,myData[i]);
+
+	pq.Print();
+
+	pq.Replace(1,5);   // 71 -> 5
+	pq.Replace(0,60);  // 8 -> 60
+	pq.Erase(4);       // remove 10
+	pq.ReplaceMin(55); // 5 -> 55
+
+	pq.Print();
+
+	std::cout << "consistent: " << pq.IsMinHeap() << std::endl;
+
+	while (!pq.Empty())
+	{
+		std::cout << pq.MinHandle() << ":" << pq.PeekMin() << std::endl;
+		pq.PopMin();
+	}
+}
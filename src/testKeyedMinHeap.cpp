@@ -0,0 +1,33 @@
+#include <vector>
+#include "keyedMinHeap.hpp"
+
+//! key of an int element is the element itself
+struct IntKey {
+	long long operator()(int x) { return x; }
+};
+
+int main()
+{
+
+	std::vector<int> myData = {8,71,41,31,10,11,16,46,51,31,21,13};
+
+	KeyedMinHeap<int,IntKey> kh;
+
+	// handle i owns myData[i]
+	for (int i = 0;i < (int) myData.size();++ i)
+		kh.Enqueue(i,myData[i]);
+
+	kh.Print();
+
+	kh.Replace(1,5);   // 71 -> 5
+	kh.Erase(4);       // remove 10
+
+	std::cout << "consistent: " << kh.IsMinHeap() << std::endl;
+
+	// ties (31) depart in handle order
+	while (!kh.Empty())
+	{
+		std::cout << kh.MinHandle() << ":" << kh.PeekMin() << std::endl;
+		kh.PopMin();
+	}
+}
@@ -7,6 +7,7 @@ int main()
 	std::vector<int> myData = {8,71,41,31,10,11,16,46,51,31,21,13};
 
 	MinHeap<int> minH(myData);
+	minH.SetCheckMode(HEAP_CHECK_FULL);
 
 	minH.Print();
 
@@ -14,10 +15,17 @@ int main()
 
 	minH.Print();
 
+	std::vector<int> batch = {3,60,27,90,5,44,12,70,1,33};
+	minH.InsertRange(batch.begin(),batch.end());
+
+	minH.Print();
+
 	int n = minH.Size();
 	while (n >= 1)
 	{
 		std::cout << minH.ExtractMin() << std::endl;
 		-- n;
 	}	
+
+	std::cout << "heap violations: " << minH.ViolationCount() << std::endl;
 }
\ No newline at end of file
@@ -15,6 +15,8 @@ int main()
 
 	pq.Print();
 
+	std::cout << "drained below 13: " << pq.DrainUntil(13) << std::endl;
+
 	int n = pq.Size();
 	while (n >= 1)
 	{
@@ -0,0 +1,37 @@
+#include <vector>
+#include "radixHeap.hpp"
+
+//! key of an int element is the element itself
+struct IntKey {
+	long long operator()(int x) { return x; }
+};
+
+int main()
+{
+
+	std::vector<int> myData = {8,71,41,31,10,11,16,46,51,31,21,13};
+
+	RadixHeap<int,IntKey> rh;
+
+	// handle i owns myData[i]
+	for (int i = 0;i < (int) myData.size();++ i)
+		rh.Enqueue(i,myData[i]);
+
+	rh.Print();
+
+	// keys inserted from now on must not be below the last extracted minimum
+	while (!rh.Empty())
+	{
+		int handle = rh.MinHandle();
+		int minElem = rh.PeekMin();
+		std::cout << handle << ":" << minElem << std::endl;
+		if (minElem < 20)
+			rh.ReplaceMin(minElem + 50);
+		else
+			rh.PopMin();
+	}
+
+	rh.Clear();
+	rh.Enqueue(0,1);
+	std::cout << "after Clear(): " << rh.PeekMin() << std::endl;
+}
@@ -0,0 +1,35 @@
+#include <vector>
+#include "ringQueue.hpp"
+
+int main()
+{
+
+	std::vector<int> myData = {8,71,41,31,10,11,16,46,51,31,21,13};
+
+	RingQueue<int> rq;
+
+	// wrap around the first 8 slots before growing
+	for (int i = 0;i < 6;++ i)
+		rq.Push(myData[i]);
+	for (int i = 0;i < 4;++ i)
+		rq.Pop();
+	for (int i = 6;i < (int) myData.size();++ i)
+		rq.Push(myData[i]);
+
+	rq.Print();
+	std::cout << "size " << rq.Size() << ", capacity " << rq.Capacity() << std::endl;
+
+	// the buffer is kept, so refilling it does not grow it
+	rq.Clear();
+	for (int i = 0;i < (int) myData.size();++ i)
+		rq.Push(myData[i]);
+	std::cout << "capacity " << rq.Capacity() << std::endl;
+
+	// elements depart in arrival order
+	while (!rq.Empty())
+	{
+		std::cout << rq.Front() << " ";
+		rq.Pop();
+	}
+	std::cout << std::endl;
+}
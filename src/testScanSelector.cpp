@@ -0,0 +1,47 @@
+#include <vector>
+#include "scanSelector.hpp"
+
+//! key of an int element is the element itself
+struct IntKey {
+	double operator()(int x) { return x; }
+};
+
+//! key of a long long element is the element itself, kept as an integer
+struct LongKey {
+	long long operator()(long long x) { return x; }
+};
+
+int main()
+{
+
+	std::vector<int> myData = {8,71,41,31,10,11,16,46,51,31,21,13};
+
+	ScanSelector<int,IntKey> ss;
+
+	// handle i owns myData[i]
+	for (int i = 0;i < (int) myData.size();++ i)
+		ss.Enqueue(i,myData[i]);
+
+	ss.Print();
+
+	ss.Replace(1,5);   // 71 -> 5
+	ss.Erase(4);       // remove 10
+
+	// ties (31) depart in handle order
+	while (!ss.Empty())
+	{
+		std::cout << ss.MinHandle() << ":" << ss.PeekMin() << std::endl;
+		ss.PopMin();
+	}
+
+	// integer keys are exact beyond 2^53, where doubles would tie them
+	ScanSelector<long long,LongKey> ls;
+	ls.Enqueue(0,(1LL << 60) + 1);
+	ls.Enqueue(1,(1LL << 60));
+	ls.Enqueue(2,(1LL << 60) + 2);
+	while (!ls.Empty())
+	{
+		std::cout << ls.MinHandle() << ":" << ls.PeekMin() << std::endl;
+		ls.PopMin();
+	}
+}
@@ -0,0 +1,33 @@
+#include <vector>
+#include "tournamentTree.hpp"
+
+//! key of an int element is the element itself
+struct IntKey {
+	long long operator()(int x) { return x; }
+};
+
+int main()
+{
+
+	std::vector<int> myData = {8,71,41,31,10,11,16,46,51,31,21,13};
+
+	TournamentTree<int,IntKey> tt(16);
+
+	// handle i owns myData[i]
+	for (int i = 0;i < (int) myData.size();++ i)
+		tt.Enqueue(i,myData[i]);
+
+	tt.Print();
+
+	tt.Replace(1,5);   // 71 -> 5
+	tt.Erase(4);       // remove 10
+
+	std::cout << "consistent: " << tt.IsTournament() << std::endl;
+
+	// ties (31) depart in handle order
+	while (!tt.Empty())
+	{
+		std::cout << tt.MinHandle() << ":" << tt.PeekMin() << std::endl;
+		tt.PopMin();
+	}
+}
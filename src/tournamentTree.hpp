@@ -0,0 +1,224 @@
+/*
+	C++ Implementation for Tournament Tree
+	version 1.0.0
+
+*/
+
+#ifndef TOURNAMENT_TREE_HPP
+#define TOURNAMENT_TREE_HPP
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <algorithm> // fill
+#include <type_traits> // conditional
+#include <stdint.h> // uint64_t UINT64_MAX
+#include <stdexcept> // underflow out_of_range
+#include "keyBits.hpp"
+
+//! key bits of a tournament tree slot without element (+infinity)
+const uint64_t TT_IDLE_KEY = UINT64_MAX;
+
+//! A function to get the # of leaves of a tournament over n slots: the smallest power of 2 >= max(n,2)
+constexpr int TTLeafNum(int n,int leafNum = 2)
+{
+	return (leafNum >= n) ? leafNum : TTLeafNum(n,2 * leafNum);
+}
+
+//! The tournament tree class
+/*!
+	Complete binary tournament over a fixed set of slots (e.g., flow indices):
+	slot h is the leaf mLeafNum + h, and every internal node i stores the
+	handle winning the match between its children 2i and 2i + 1. Slots without
+	element carry the key +infinity (TT_IDLE_KEY), so they never win against a
+	backlogged slot. Changing the element of a slot replays exactly the
+	log2(mLeafNum) matches on the path from its leaf to the root, reading the
+	cached keys only and moving no elements; the winner is always at node 1.
+	Internal nodes store winners rather than losers: replaying a loser tree is
+	only correct for the leaf of the current winner, while GPSSim also changes
+	other slots (arrivals to idle flows, TearDownFlow(), SetFlowWeight()).
+	Ties on the key are resolved to the smaller handle.
+	With Capacity > 0 the slots are fixed at compile time: all arrays are
+	std::array members, nothing is allocated, and handles >= Capacity throw.
+	Keys are given by KeyOf as non-negative doubles or integers, see KeyBits().
+	Offers the same interface as IndexedPriorityQueue.
+*/
+template <class TYPE,class KeyOf,int Capacity = 0>
+class TournamentTree{
+	static_assert(Capacity >= 0,"TournamentTree capacity must be non-negative.");
+	//! storage of N elements of type T: growable if Capacity is 0, fixed otherwise
+	template <class T,int N>
+	using Storage = typename std::conditional<Capacity == 0,std::vector<T>,std::array<T,N> >::type;
+	//! # of leaves (a power of 2)
+	int mLeafNum;
+	//! winning handle of each node, stored from index 1; leaves hold their own handle
+	Storage<int,2 * TTLeafNum(Capacity)> mWinners;
+	//! key bits of each slot's element, TT_IDLE_KEY if the slot has no element
+	Storage<uint64_t,TTLeafNum(Capacity)> mKeys;
+	//! element of each slot
+	Storage<TYPE,TTLeafNum(Capacity)> mValues;
+	//! # of elements
+	int mSize;
+	//! key function
+	KeyOf mKeyOf;
+	//! A function to play the match between handles h1 and h2, returning the winner
+	inline int Play(int h1,int h2)
+	{
+		return (mKeys[h2] < mKeys[h1] || (mKeys[h2] == mKeys[h1] && h2 < h1)) ? h2 : h1;
+	}
+	//! A function to replay the matches on the path from the leaf of a handle to the root
+	void Replay(int handle)
+	{
+		for (int i = (mLeafNum + handle) >> 1;i >= 1;i >>= 1)
+			mWinners[i] = Play(mWinners[2 * i],mWinners[2 * i + 1]);
+	}
+	//! A function to play all matches, bottom-up
+	void Build()
+	{
+		for (int i = mLeafNum - 1;i >= 1;-- i)
+			mWinners[i] = Play(mWinners[2 * i],mWinners[2 * i + 1]);
+	}
+	//! A function to extend growable storage from oldNum to num elements, filling the new ones with x
+	template <class T>
+	static void Extend(std::vector<T>& v,int,int num,const T& x)
+	{
+		v.resize(num,x);
+	}
+	//! A function to fill the fixed storage from oldNum to num elements with x
+	template <class T,size_t N>
+	static void Extend(std::array<T,N>& a,int oldNum,int num,const T& x)
+	{
+		std::fill(a.begin() + oldNum,a.begin() + num,x);
+	}
+	//! A function to resize the tree to at least handleNum leaves, keeping the elements
+	void Grow(int handleNum)
+	{
+		if (Capacity > 0 && handleNum > Capacity)
+			throw new std::out_of_range("TournamentTree capacity exceeded.");
+		int leafNum = TTLeafNum(Capacity > 0 ? Capacity : handleNum);
+		Extend(mKeys,mLeafNum,leafNum,TT_IDLE_KEY);
+		Extend(mValues,mLeafNum,leafNum,TYPE());
+		Extend(mWinners,0,2 * leafNum,0);
+		mLeafNum = leafNum;
+		for (int h = 0;h < mLeafNum;++ h)
+			mWinners[mLeafNum + h] = h;
+		Build();
+	}
+	//! A function to check that a handle owns an element
+	void CheckHandle(int handle)
+	{
+		if (!Contains(handle))
+			throw new std::out_of_range("TournamentTree has no element with this handle.");
+	}
+public:
+	//! A constructor with the number of slots specified
+	explicit TournamentTree(int handleNum = 0,KeyOf uKeyOf = KeyOf())// constructor
+	{
+		mLeafNum = 0;
+		mSize = 0;
+		mKeyOf = uKeyOf;
+		Grow(handleNum);
+	}
+	//! A function to check whether a handle currently owns an element
+	bool Contains(int handle)
+	{
+		return handle >= 0 && handle < mLeafNum && mKeys[handle] != TT_IDLE_KEY;
+	}
+	//! A function to insert an element under a handle which currently owns no element
+	void Enqueue(int handle,TYPE x)
+	{
+		if (handle < 0)
+			throw new std::out_of_range("TournamentTree handle must be non-negative.");
+		if (handle >= mLeafNum) Grow(handle + 1);
+		if (mKeys[handle] != TT_IDLE_KEY)
+			throw new std::runtime_error("TournamentTree handle already owns an element.");
+		mValues[handle] = x;
+		mKeys[handle] = KeyBits(mKeyOf(x));
+		++ mSize;
+		Replay(handle);
+	}
+	//! A function to replace the element of a handle by x
+	void Replace(int handle,TYPE x)
+	{
+		CheckHandle(handle);
+		mValues[handle] = x;
+		mKeys[handle] = KeyBits(mKeyOf(x));
+		Replay(handle);
+	}
+	//! A function to replay the matches of a handle after the key of its element changed in place
+	void Update(int handle)
+	{
+		CheckHandle(handle);
+		mKeys[handle] = KeyBits(mKeyOf(mValues[handle]));
+		Replay(handle);
+	}
+	//! A function to remove the element of a handle
+	void Erase(int handle)
+	{
+		CheckHandle(handle);
+		mKeys[handle] = TT_IDLE_KEY;
+		-- mSize;
+		Replay(handle);
+	}
+	//! A function to get the handle of the minimum element
+	int MinHandle()
+	{
+		if (Empty())
+			throw new std::underflow_error("TournamentTree underflow.");
+		return mWinners[1];
+	}
+	//! A function to answer the query of the minimum element
+	TYPE PeekMin()
+	{
+		return mValues[MinHandle()];
+	}
+	//! A function to remove the minimum element
+	void PopMin()
+	{
+		Erase(MinHandle());
+	}
+	//! A function to replace the minimum element by x (owned by the same handle)
+	void ReplaceMin(TYPE x)
+	{
+		Replace(MinHandle(),x);
+	}
+	//! A function to remove all elements
+	/*! O(1) when the tree is already empty.
+	*/
+	void Clear()
+	{
+		if (mSize == 0) return;
+		std::fill(mKeys.begin(),mKeys.begin() + mLeafNum,TT_IDLE_KEY);
+		mSize = 0;
+		Build();
+	}
+	//! A function to track whether the tree is empty
+	bool Empty()
+	{
+		return (mSize == 0);
+	}
+	//! A function to get the current # of elements
+	int Size()
+	{
+		return mSize;
+	}
+	//! A function to check whether every node holds the winner of its children
+	bool IsTournament()
+	{
+		for (int i = 1;i < mLeafNum;++ i)
+			if (mWinners[i] != Play(mWinners[2 * i],mWinners[2 * i + 1])) return false;
+		return true;
+	}
+	//! A function to print out the elements (with their handles) in handle order
+	void Print()
+	{
+		for (int h = 0;h < mLeafNum;++ h)
+			if (Contains(h))
+				std::cout << h << ":" << mValues[h] << " ";
+		std::cout << std::endl;
+	}
+};
+
+
+
+#endif
@@ -0,0 +1,317 @@
+/*
+	Representations of GPS real and virtual time
+	version 1.0.0
+
+*/
+
+#ifndef VIRTUAL_TIME_HPP
+#define VIRTUAL_TIME_HPP
+
+#include <math.h> // nearbyint llround ldexp
+#include <algorithm> // min
+#include <stdint.h> // int64_t
+#include <stdexcept> // invalid_argument overflow_error
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//! real time, in nanoseconds (64-bit on every platform)
+typedef int64_t RTime;
+//! # of nanoseconds per second
+const int64_t NS_PER_SEC = 1000000000LL;
+//! default link rate, in bytes per second: one byte per nanosecond
+const double DEFAULT_LINK_RATE = 1e9;
+
+//! # of fractional bits of fixed-point virtual times (which may then reach 2^(62 - 20) = 2^42 within a busy period)
+const int VTIME_FRAC_BITS = 20;
+//! # of fractional bits of fixed-point weights
+const int WEIGHT_FRAC_BITS = 16;
+//! # of extra fractional bits of fixed-point virtual times per byte
+const int RATE_EXTRA_BITS = 26;
+static_assert(VTIME_FRAC_BITS + WEIGHT_FRAC_BITS + RATE_EXTRA_BITS <= 62,"Fixed-point virtual time per byte must fit in 63 bits.");
+//! largest fixed-point virtual time: the sum of two of them, or of one and a packet's service time, fits in 63 bits
+const long long MAX_FIXED_VTIME = (1LL << 62) - 1;
+
+//! arithmetic of the virtual time representation Time
+/*!
+	Virtual time is measured in bytes served per unit of weight, and real
+	time (RTime) in nanoseconds on a link serving a given # of bytes per
+	second. Every representation provides the type Weight of (sums of) flow
+	weights, the type Rate of virtual times per byte, the type Link of link
+	rates, the type Speed of virtual times per nanosecond, and the conversions
+	GPSSim and Flow need, so that they never depend on Time itself.
+*/
+template <class Time>
+struct VTimeOps;
+
+//! floating-point virtual time
+template <>
+struct VTimeOps<double>{
+	//! total weight of backlogged flows
+	typedef double Weight;
+	//! virtual time per byte
+	typedef double Rate;
+	//! virtual time per nanosecond
+	typedef double Speed;
+	//! link rate: bytes per nanosecond and its reciprocal
+	struct Link{
+		double mBytesPerNs;
+		double mNsPerByte;
+	};
+	//! A function to convert a link rate in bytes per second
+	static inline Link LinkOf(double bytesPerSec)
+	{
+		if (!(bytesPerSec > 0))
+			throw new std::invalid_argument("Link rate must be positive.");
+		double bytesPerNs = bytesPerSec / NS_PER_SEC;
+		return Link{bytesPerNs,1.0 / bytesPerNs};
+	}
+	//! A function to convert a flow weight
+	static inline Weight WeightOf(double weight)
+	{
+		return weight;
+	}
+	//! A function to get the virtual time per nanosecond at total weight sum
+	static inline Speed SpeedOf(Weight sum,const Link& link)
+	{
+		return link.mBytesPerNs / sum;
+	}
+	//! A function to get the virtual time per byte of a flow
+	static inline Rate PerByte(double weight)
+	{
+		return 1.0 / weight;
+	}
+	//! A function to get the virtual time to serve length bytes at perByte virtual time per byte
+	static inline double Service(long length,Rate perByte)
+	{
+		return length * perByte;
+	}
+	//! A function to get the virtual time to serve length bytes at unit weight
+	static inline double OfBytes(long length)
+	{
+		return length;
+	}
+	//! A function to get the virtual time elapsed in realTime at speed
+	static inline double Elapsed(RTime realTime,Speed speed)
+	{
+		return realTime * speed;
+	}
+	//! A function to get the virtual time elapsed in realTime among n flows of unit weight
+	static inline double ElapsedEqual(RTime realTime,int n,const Link& link)
+	{
+		return realTime * link.mBytesPerNs / n;
+	}
+	//! A function to get the real time (rounded) to advance the virtual time by vTime at total weight sum
+	static inline RTime RealTime(double vTime,Weight sum,const Link& link)
+	{
+		return (RTime) nearbyint(vTime * sum * link.mNsPerByte);
+	}
+	//! A function to get the real time (rounded) to advance the virtual time by vTime among n flows of unit weight
+	static inline RTime RealTimeEqual(double vTime,int n,const Link& link)
+	{
+		return (RTime) nearbyint(vTime * n * link.mNsPerByte);
+	}
+	//! A function to scale a virtual time span by oldWeight / newWeight
+	static inline double Rescale(double vTime,double oldWeight,double newWeight)
+	{
+		return vTime * oldWeight * PerByte(newWeight);
+	}
+	//! A function to check whether a virtual time is representable (always)
+	static inline bool InRange(double)
+	{
+		return true;
+	}
+	//! A function to convert a virtual time to a double
+	static inline double ToDouble(double vTime)
+	{
+		return vTime;
+	}
+	//! A function to replace x[i] by base + x[0] + ... + x[i] for i in [0,n)
+	/*! Added left to right, as packet after packet would be: a vectorized scan
+	    reassociates the sums and would change the rounding.
+	*/
+	static inline void PrefixSum(double base,double *x,int n)
+	{
+		for (int i = 0;i < n;++ i)
+			x[i] = base += x[i];
+	}
+};
+
+//! fixed-point virtual time with VTIME_FRAC_BITS fractional bits
+/*!
+	Weights are rounded to WEIGHT_FRAC_BITS fractional bits, link rates to
+	whole bytes per second, and all arithmetic is integer (128-bit where
+	products may overflow, which bounds the real time between two events to
+	about 2^57 ns at 100 Gb/s), so results
+	do not depend on compiler, flags or evaluation order.
+	Virtual times of a busy period must stay within MAX_FIXED_VTIME, i.e.,
+	2^42 bytes per unit of weight, which virtual time reaches after 73 minutes
+	at one byte per nanosecond among a total weight of 1 (44 seconds at total
+	weight 0.01). InRange() tells finish times beyond it, which GPSSim
+	reports instead of wrapping around. Divisions round to
+	nearest, and real times are rounded half to even like nearbyint() does.
+	Results are close to, but not bit-identical with, floating-point virtual
+	time: a departure whose real time is an exact rounding tie may land on
+	either tick depending on the representation error.
+*/
+template <>
+struct VTimeOps<long long>{
+	//! total weight of backlogged flows, in units of 2^-WEIGHT_FRAC_BITS
+	typedef long long Weight;
+	//! virtual time per byte, with RATE_EXTRA_BITS more fractional bits than virtual times
+	typedef long long Rate;
+	//! link rate: integer bytes per second
+	struct Link{
+		long long mBytesPerSec;
+	};
+	//! virtual time per nanosecond, kept as the link rate and total weight it is the ratio of
+	struct Speed{
+		long long mBytesPerSec;
+		Weight mSum;
+	};
+	//! A function to convert a link rate in bytes per second
+	static inline Link LinkOf(double bytesPerSec)
+	{
+		long long rate = llround(bytesPerSec);
+		if (rate <= 0)
+			throw new std::invalid_argument("Link rate must be positive.");
+		return Link{rate};
+	}
+	//! A function to convert a flow weight
+	static inline Weight WeightOf(double weight)
+	{
+		Weight w = llround(ldexp(weight,WEIGHT_FRAC_BITS));
+		if (w <= 0)
+			throw new std::invalid_argument("Flow weight is below the fixed-point resolution.");
+		return w;
+	}
+	//! A function to get the virtual time per nanosecond at total weight sum (Elapsed() divides exactly)
+	static inline Speed SpeedOf(Weight sum,const Link& link)
+	{
+		return Speed{link.mBytesPerSec,sum};
+	}
+	//! A function to get the virtual time per byte of a flow
+	static inline Rate PerByte(double weight)
+	{
+		Weight w = WeightOf(weight);
+		return ((1LL << (VTIME_FRAC_BITS + WEIGHT_FRAC_BITS + RATE_EXTRA_BITS)) + w / 2) / w;
+	}
+	//! A function to get the virtual time to serve length bytes at perByte virtual time per byte
+	static inline long long Service(long length,Rate perByte)
+	{
+		return (long long) (((__int128) length * perByte + (1LL << (RATE_EXTRA_BITS - 1))) >> RATE_EXTRA_BITS);
+	}
+	//! A function to get the virtual time to serve length bytes at unit weight
+	static inline long long OfBytes(long length)
+	{
+		return (long long) length << VTIME_FRAC_BITS;
+	}
+	//! A function to divide non-negative x by positive y, rounding to nearest with halves up
+	static inline long long RoundDiv(__int128 x,__int128 y)
+	{
+		return (long long) ((x + y / 2) / y);
+	}
+	//! A function to divide non-negative x by positive y, rounding to nearest with halves to even
+	static inline long long RoundDivEven(__int128 x,__int128 y)
+	{
+		__int128 q = x / y;
+		__int128 rem2 = 2 * (x - q * y);
+		if (rem2 > y || (rem2 == y && (q & 1))) ++ q;
+		return (long long) q;
+	}
+	//! A function to get the virtual time elapsed in realTime at speed
+	static inline long long Elapsed(RTime realTime,const Speed& speed)
+	{
+		return RoundDiv(((__int128) realTime * speed.mBytesPerSec) << (VTIME_FRAC_BITS + WEIGHT_FRAC_BITS),(__int128) speed.mSum * NS_PER_SEC);
+	}
+	//! A function to get the virtual time elapsed in realTime among n flows of unit weight
+	static inline long long ElapsedEqual(RTime realTime,int n,const Link& link)
+	{
+		return RoundDiv(((__int128) realTime * link.mBytesPerSec) << VTIME_FRAC_BITS,(__int128) n * NS_PER_SEC);
+	}
+	//! A function to get the real time (rounded) to advance the virtual time by vTime at total weight sum
+	static inline RTime RealTime(long long vTime,Weight sum,const Link& link)
+	{
+		return RoundDivEven((__int128) vTime * sum * NS_PER_SEC,(__int128) link.mBytesPerSec << (VTIME_FRAC_BITS + WEIGHT_FRAC_BITS));
+	}
+	//! A function to get the real time (rounded) to advance the virtual time by vTime among n flows of unit weight
+	static inline RTime RealTimeEqual(long long vTime,int n,const Link& link)
+	{
+		return RoundDivEven((__int128) vTime * n * NS_PER_SEC,(__int128) link.mBytesPerSec << VTIME_FRAC_BITS);
+	}
+	//! A function to scale a virtual time span by oldWeight / newWeight
+	static inline long long Rescale(long long vTime,double oldWeight,double newWeight)
+	{
+		Weight w = WeightOf(newWeight);
+		__int128 scaled = ((__int128) vTime * WeightOf(oldWeight) + w / 2) / w;
+		return (long long) std::min(scaled,(__int128) MAX_FIXED_VTIME + 1);
+	}
+	//! A function to check whether a virtual time is within [0,MAX_FIXED_VTIME]
+	static inline bool InRange(long long vTime)
+	{
+		return vTime >= 0 && vTime <= MAX_FIXED_VTIME;
+	}
+	//! A function to convert a virtual time to a double
+	static inline double ToDouble(long long vTime)
+	{
+		return ldexp((double) vTime,-VTIME_FRAC_BITS);
+	}
+	//! A function to replace x[i] by base + x[0] + ... + x[i] for i in [0,n)
+	/*! Integer sums are exact in any order, so lanes are scanned in log2(lanes)
+	    shifted additions and the total of each vector is carried to the next.
+	    Sums beyond the range wrap around (see InRange()).
+	*/
+	static inline void PrefixSum(long long base,long long *x,int n)
+	{
+		int i = 0;
+#if defined(__AVX2__)
+		__m256i zero = _mm256_setzero_si256();
+		__m256i carry = _mm256_set1_epi64x(base);
+		for (;i + 4 <= n;i += 4)
+		{
+			__m256i v = _mm256_loadu_si256((const __m256i *) (x + i));
+			//! add the lanes shifted up by one, then by two
+			v = _mm256_add_epi64(v,_mm256_blend_epi32(_mm256_permute4x64_epi64(v,0x90),zero,0x03));
+			v = _mm256_add_epi64(v,_mm256_blend_epi32(_mm256_permute4x64_epi64(v,0x40),zero,0x0F));
+			v = _mm256_add_epi64(v,carry);
+			_mm256_storeu_si256((__m256i *) (x + i),v);
+			carry = _mm256_permute4x64_epi64(v,0xFF);
+		}
+#elif defined(__SSE2__)
+		__m128i carry = _mm_set1_epi64x(base);
+		for (;i + 2 <= n;i += 2)
+		{
+			__m128i v = _mm_loadu_si128((const __m128i *) (x + i));
+			v = _mm_add_epi64(v,_mm_slli_si128(v,8));
+			v = _mm_add_epi64(v,carry);
+			_mm_storeu_si128((__m128i *) (x + i),v);
+			carry = _mm_shuffle_epi32(v,0xEE);
+		}
+#endif
+		if (i > 0) base = x[i - 1];
+		for (;i < n;++ i)
+			x[i] = base = (long long) ((unsigned long long) base + x[i]);
+	}
+};
+
+//! representation of virtual times, selected at compile time
+/*! Define GPS_FIXED_POINT_VTIME for integer fixed-point virtual times: heap keys then
+    compare as integers and results are bit-identical across compilers and platforms.
+*/
+#if defined(GPS_FIXED_POINT_VTIME)
+typedef long long VTime;
+#else
+typedef double VTime;
+#endif
+
+//! A function to check that a new finish time is representable
+inline void CheckFinishTime(VTime vfTime)
+{
+	if (!VTimeOps<VTime>::InRange(vfTime))
+		throw new std::overflow_error("Virtual finish time exceeds the fixed-point range: the busy period is too long for the flow weights.");
+}
+
+
+#endif